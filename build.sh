@@ -1,3 +1,9 @@
-eosio-cpp ./dconnect-reward.cpp -o dconnect-reward.wasm
+#policy values can be passed in too, e.g. FLAGS="-DDCONNECT_LOCK_PERIOD=3600" ./build.sh
+#PROFILE=speed builds with -O3, otherwise -Oz as the cmake build's size profile does
+if [ "$PROFILE" = "speed" ]; then FLAGS="$FLAGS -O3"; else FLAGS="$FLAGS -Oz"; fi
+if [ -n "$ARENA" ]; then FLAGS="$FLAGS -DDCONNECT_ARENA"; fi
+if [ -n "$RAW_DISPATCH" ]; then FLAGS="$FLAGS -DDCONNECT_RAW_DISPATCH"; fi
+if [ -n "$RUNTIME_POLICY" ]; then FLAGS="$FLAGS -DDCONNECT_RUNTIME_POLICY"; fi
+if [ -n "$DROP_MEMOS" ]; then FLAGS="$FLAGS -DDCONNECT_DROP_MEMOS"; fi
+eosio-cpp $FLAGS ./dconnect-reward.cpp -o dconnect-reward.wasm
 cleos -u https://dconnect.live set contract glitchtester ./
-
@@ -0,0 +1,15 @@
+# prints the wasm size, then the code size of each function when twiggy or
+# wasm-objdump is installed
+file(READ ${WASM} contents HEX)
+string(LENGTH "${contents}" hex_length)
+math(EXPR wasm_size "${hex_length} / 2")
+message("${WASM}: ${wasm_size} bytes")
+
+if(TWIGGY)
+   execute_process(COMMAND ${TWIGGY} top -n 40 ${WASM})
+elseif(WASM_OBJDUMP)
+   execute_process(COMMAND ${WASM_OBJDUMP} -h ${WASM})
+   execute_process(COMMAND ${WASM_OBJDUMP} -x -j Code ${WASM})
+else()
+   message("install twiggy or wabt for a per-function breakdown")
+endif()
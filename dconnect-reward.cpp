@@ -4,8 +4,21 @@
  */
 
 #include "dconnect-reward/dconnect-reward.hpp"
+#include "dconnect-reward/commitment.hpp"
+#include "dconnect-reward/hot.hpp"
+#include "dconnect-reward/settle.hpp"
+
+#ifdef DCONNECT_ARENA
+#include "dconnect-reward/arena.hpp"
+#endif
 
 namespace eosio {
+
+//the settlement arithmetic at the policy's rates
+void token::settle_amounts( const int64_t* quantity, int64_t* payout, int64_t* cut, int64_t* minted, size_t n ) {
+   settle_batch( quantity, payout, cut, minted, n, policy::payout_rate(), policy::vote_rate(), policy::rate_base() );
+}
+
 //on top of eos properties we add some for bounty management
 void token::create( name   issuer,
                     asset  maximum_supply,
@@ -20,6 +33,7 @@ void token::create( name   issuer,
     eosio_assert( sym.is_valid(), "invalid symbol name" );
     eosio_assert( maximum_supply.is_valid(), "invalid supply");
     eosio_assert( maximum_supply.amount > 0, "max-supply must be positive");
+    eosio_assert( policy::precision() < 0 || sym.precision() == policy::precision(), "symbol precision not allowed by policy" );
 
     stats statstable( _self, sym.code().raw() );
     auto existing = statstable.find( sym.code().raw() );
@@ -34,14 +48,40 @@ void token::create( name   issuer,
        s.max_supply      = maximum_supply;
        s.issuer          = issuer;
     });
+    add_bounty_source( bounty_contract );
 }
 
 
+//only builds with DCONNECT_RUNTIME_POLICY read the config, and it can only change while no
+//rewards are locked since their maturity is worked out from the current lock period
+void token::setconfig( uint32_t lock_period, int64_t payout_rate, int64_t vote_rate,
+                       int64_t rate_base, uint32_t memo_limit, int32_t precision )
+{
+    require_auth( _self );
+    eosio_assert( !policy::fixed, "policy is fixed at build time" );
+    eosio_assert( rate_base > 0, "rate base must be positive" );
+    eosio_assert( payout_rate >= rate_base && vote_rate >= rate_base, "rates can't pay out less than was locked" );
+    eosio_assert( memo_limit <= 256, "memo limit is at most 256 bytes" );
+
+    metrics queues( _self, _self.value );
+    eosio_assert( queues.get_or_default().reward_due == 0, "locked rewards must settle before the policy changes" );
+
+    policy_config config;
+    config.lock_period = lock_period;
+    config.payout_rate = payout_rate;
+    config.vote_rate = vote_rate;
+    config.rate_base = rate_base;
+    config.memo_limit = memo_limit;
+    config.precision = precision;
+    policy_configs( _self, _self.value ).set( config, _self );
+    policy::reset();
+}
+
 void token::issue( name to, asset quantity, string memo )
 {
     auto sym = quantity.symbol;
     eosio_assert( sym.is_valid(), "invalid symbol name" );
-    eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
+    eosio_assert( memo.size() <= policy::memo_limit(), "memo is too long" );
 
     stats statstable( _self, sym.code().raw() );
     auto existing = statstable.find( sym.code().raw() );
@@ -74,7 +114,7 @@ void token::reward(  name to, name vote,asset quantity, string memo, int64_t con
     require_auth( to );
     auto sym = quantity.symbol;
     eosio_assert( sym.is_valid(), "invalid symbol name" );
-    eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
+    eosio_assert( memo.size() <= policy::memo_limit(), "memo is too long" );
 
     stats statstable( _self, sym.code().raw() );
     auto existing = statstable.find( sym.code().raw() );
@@ -87,45 +127,73 @@ void token::reward(  name to, name vote,asset quantity, string memo, int64_t con
 
     sub_balance( to, quantity );
     payouts rewardstable( _self, name("rewards").value );
-    rewardstable.emplace( _self, [&]( auto& a ) {
-      a.pk = rewardstable.available_primary_key();
+    cursor settlement( _self, _self.value );
+    auto cur = settlement.get_or_default();
+    uint64_t memo_id = intern_memo( memo );
+    auto row = rewardstable.emplace( _self, [&]( auto& a ) {
+      a.pk = std::max( rewardstable.available_primary_key(), cur.reward_key );
       a.vote = vote;
       a.content = content;
       a.to = to;
-      a.memo = memo;
+      a.memo = memo_id;
       a.time = now();
       a.quantity = quantity;
     });
+    add_maturity( quantity, now() + policy::lock_period() );
+    int64_t payout, cut, minted;
+    settle_amounts( &quantity.amount, &payout, &cut, &minted, 1 );
+    add_pending( to, quantity, asset( payout, quantity.symbol ), now() + policy::lock_period() );
+    SEND_INLINE_ACTION( *this, logreward, { {_self, "active"_n} },
+      { row->pk, to, vote, quantity, row->content, now() + policy::lock_period() }
+    );
+
+    metrics queues( _self, _self.value );
+    auto m = queues.get_or_default();
+    auto& q = metrics_for( m, st );
+    q.reward_count++;
+    q.pending_rewards += quantity;
+    if( m.reward_due == 0 ) {
+      m.reward_due = now() + policy::lock_period();
+    }
+    queues.set( m, _self );
+
+   uint64_t sym_raw = sym.code().raw();
+   uint64_t reward_hot = hot_score( quantity.amount, now() );
 
    totals usertotals( _self, to.value );
-   auto total = usertotals.find( 0 );
+   auto total = usertotals.find( sym_raw );
    if( total == usertotals.end() ) {
       usertotals.emplace( _self, [&]( auto& a ){
-	      a.pk = rewardstable.available_primary_key();
+	      a.pk = sym_raw;
 	      a.content = content;
-	      a.user = to;
+	      a.name = to;
 	      a.time = now();
 	      a.quantity = quantity;
+	      a.hot = reward_hot;
       });
    } else {
-      usertotals.modify( to, same_payer, [&]( auto& a ) {
+      usertotals.modify( total, same_payer, [&]( auto& a ) {
         a.quantity.amount += quantity.amount;
+        a.hot = hot_add( a.hot, reward_hot );
       });
    }
 
-   totals posttotals( _self, content );
-   auto ptotal = posttotals.find( 0 );
+   //every content total lives in one scope so the byhot index ranks them all
+   contents posttotals( _self, _self.value );
+   auto ptotal = posttotals.find( content );
    if( ptotal == posttotals.end() ) {
       posttotals.emplace( _self, [&]( auto& a ){
-	      a.pk = rewardstable.available_primary_key();
+	      a.pk = content;
 	      a.content = content;
-	      a.user = to;
+	      a.name = to;
 	      a.time = now();
 	      a.quantity = quantity;
+	      a.hot = reward_hot;
       });
    } else {
-      posttotals.modify( to, same_payer, [&]( auto& a ) {
+      posttotals.modify( ptotal, same_payer, [&]( auto& a ) {
         a.quantity.amount += quantity.amount;
+        a.hot = hot_add( a.hot, reward_hot );
       });
    }
 }
@@ -135,7 +203,7 @@ void token::retire( name to,  asset quantity, string memo )
     require_auth( to );
     auto sym = quantity.symbol;
     eosio_assert( sym.is_valid(), "invalid symbol name" );
-    eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
+    eosio_assert( memo.size() <= policy::memo_limit(), "memo is too long" );
 
     stats statstable( _self, sym.code().raw() );
     auto existing = statstable.find( sym.code().raw() );
@@ -154,85 +222,321 @@ void token::retire( name to,  asset quantity, string memo )
     asset payout_asset = asset((uint64_t)4, st.bounty.symbol);
     payout_asset.amount = amount;
 
-    print(" quantity_amount: ");
-    print(quantity.amount);
-    print(" supply_amount: ");
-    print(st.supply.amount);
-    print(" share: ");
-    print(share);
-    print(" amount: ");
-    print(payout_asset.amount);
     eosio_assert(payout_asset.amount>0, "Not enough to claim with.");
     sub_balance( to, quantity );
+    eosio_assert(payout_asset <= st.bounty, "Not enough bounty to claim from.");
     statstable.modify( st, same_payer, [&]( auto& s ) {
      s.supply -= quantity;
+     s.bounty -= payout_asset;
     });
+    //a user with an undrained payout in this symbol gets it topped up instead of a new row.
+    //The row keeps the memo of the retire that made it, and a merged retire's memo is never interned
     payouts payoutstable( _self, name("payouts").value );
-    payoutstable.emplace( _self, [&]( auto& a ){
-      a.pk = payoutstable.available_primary_key();
-      a.bounty = payout_asset;
-      a.to = to;
-      a.memo = memo;
-      a.time = now();
-      a.quantity = quantity;
-    });
+    auto byowner = payoutstable.get_index<"byowner"_n>();
+    auto pending = byowner.lower_bound( to.value );
+    while( pending != byowner.end() && pending->to == to && pending->quantity.symbol != quantity.symbol ) {
+      ++pending;
+    }
+    bool merged = pending != byowner.end() && pending->to == to;
+    uint64_t key;
+    if( merged ) {
+      key = pending->pk;
+      byowner.modify( pending, same_payer, [&]( auto& a ) {
+        a.bounty += payout_asset;
+        a.quantity += quantity;
+      });
+    } else {
+      cursor settlement( _self, _self.value );
+      auto cur = settlement.get_or_default();
+      uint64_t memo_id = intern_memo( memo );
+      auto row = payoutstable.emplace( _self, [&]( auto& a ){
+        a.pk = std::max( payoutstable.available_primary_key(), cur.payout_key );
+        a.bounty = payout_asset;
+        a.to = to;
+        a.memo = memo_id;
+        a.time = now();
+        a.quantity = quantity;
+      });
+      key = row->pk;
+    }
+    SEND_INLINE_ACTION( *this, logretire, { {_self, "active"_n} },
+      { key, to, quantity, payout_asset }
+    );
+
+    metrics queues( _self, _self.value );
+    auto m = queues.get_or_default();
+    auto& q = metrics_for( m, st );
+    if( !merged ) {
+      q.payout_count++;
+    }
+    q.pending_payouts += payout_asset;
+    if( m.payout_due == 0 ) {
+      m.payout_due = now();
+    }
+    queues.set( m, _self );
+}
+
+//carries tables over from another deployment. rows holds one table's rows packed back to back,
+//each after its scope, sorted by scope then primary key. Queue rows also rebuild the pending,
+//bucket and metrics rows that follow from them, so a token's stat row must come first
+void token::importrows( name table, const std::vector<char>& rows )
+{
+    require_auth( _self );
+    datastream<const char*> ds( rows.data(), rows.size() );
+
+    if( table == name("accounts") ) {
+      import_table<accounts, account>( ds, [&]( uint64_t scope, const account& row ) {
+        commit_balance( name( scope ), asset( 0, row.balance.symbol ), row.balance );
+      });
+    } else if( table == name("stat") ) {
+      import_table<stats, currency_stats>( ds, [&]( uint64_t, const currency_stats& row ) {
+        add_bounty_source( row.bounty_contract );
+      });
+    } else if( table == name("totals") ) {
+      import_table<totals, total>( ds, []( uint64_t, const total& ) {} );
+    } else if( table == name("contents") ) {
+      import_table<contents, total>( ds, []( uint64_t, const total& ) {} );
+    } else if( table == name("payouts") ) {
+      metrics queues( _self, _self.value );
+      auto m = queues.get_or_default();
+      import_table<payouts, payout>( ds, [&]( uint64_t scope, const payout& row ) {
+        uint64_t sym_raw = row.quantity.symbol.code().raw();
+        stats statstable( _self, sym_raw );
+        const auto& st = statstable.get( sym_raw, "token of an imported queue row does not exist" );
+        auto& q = metrics_for( m, st );
+        uint32_t maturity = row.time + policy::lock_period();
+        if( scope == name("rewards").value ) {
+          add_maturity( row.quantity, maturity );
+          int64_t payout, cut, minted;
+          settle_amounts( &row.quantity.amount, &payout, &cut, &minted, 1 );
+          add_pending( row.to, row.quantity, asset( payout, row.quantity.symbol ), maturity );
+          q.reward_count++;
+          q.pending_rewards += row.quantity;
+          if( m.reward_due == 0 ) {
+            m.reward_due = maturity;
+          }
+        } else {
+          q.payout_count++;
+          q.pending_payouts += row.bounty;
+          if( m.payout_due == 0 ) {
+            m.payout_due = row.time;
+          }
+        }
+      });
+      queues.set( m, _self );
+    } else {
+      eosio_assert( false, "table can't be imported" );
+    }
+}
+
+//memo ids of queue rows refer to the old deployment's memos table, which isn't carried over
+template<typename Table, typename Row, typename F>
+void token::import_table( datastream<const char*>& ds, F&& imported )
+{
+    uint64_t last_scope = 0;
+    uint64_t last_key = 0;
+    bool first = true;
+    //settlement resumes from the cursor, so a queue row keyed below it would never be settled
+    cursor_state cur;
+    if constexpr( std::is_same<Row, payout>::value ) {
+      cursor settlement( _self, _self.value );
+      cur = settlement.get_or_default();
+    }
+    while( ds.remaining() > 0 ) {
+      uint64_t scope;
+      Row row;
+      ds >> scope >> row;
+      uint64_t key = row.primary_key();
+      eosio_assert( first || scope > last_scope || ( scope == last_scope && key > last_key ),
+                    "rows must be sorted by scope then key" );
+      if constexpr( std::is_same<Row, payout>::value ) {
+        eosio_assert( scope == name("rewards").value || scope == name("payouts").value, "queue rows must be in the rewards or payouts scope" );
+        eosio_assert( row.pk >= ( scope == name("rewards").value ? cur.reward_key : cur.payout_key ),
+                      "queue row key is below the settlement cursor" );
+        row.memo = 0;
+      }
+      //contents rows are scoped by the contract's own account, which the byhot ranking reads
+      if constexpr( std::is_same<Table, contents>::value ) {
+        eosio_assert( scope == _self.value, "contents rows must be in the contract's own scope" );
+      }
+      Table table( _self, scope );
+      table.emplace( _self, [&]( auto& a ) {
+        a = row;
+      });
+      imported( scope, row );
+      first = false;
+      last_scope = scope;
+      last_key = key;
+    }
 }
 
 void token::pay() {
     require_auth( _self );
-    print("running payments\n");
+    settle( 1 );
+    transaction out{};
+    out.actions.emplace_back(permission_level{_self, name("active")}, _self, name("pay"), std::make_tuple());
+    out.delay_sec = 60;
+    out.send(0, _self, true);
+}
+
+//anyone can drive settlement, the work done per call is bounded by max_items
+void token::crank( uint32_t max_items ) {
+    eosio_assert( max_items > 0, "must crank at least one item" );
+    eosio_assert( settle( max_items ) > 0, "nothing to settle" );
+}
+
+uint32_t token::settle( uint32_t max_items ) {
     payouts payoutstable( _self, name("payouts").value);
-    print("payouts table");
     payouts rewardstable( _self, name("rewards").value);
-    print("rewards table");
-    int done = false;
-    print(done);
-    for(auto itr = payoutstable.begin(); itr != payoutstable.end() && !done;) {
-      print(done);
-      print(itr->to);
+    cursor settlement( _self, _self.value );
+    auto cur = settlement.get_or_default();
+    metrics queues( _self, _self.value );
+    auto m = queues.get_or_default();
+    uint32_t done = 0;
+    auto itr = payoutstable.lower_bound(cur.payout_key);
+    for(; itr != payoutstable.end() && done < max_items;) {
+      stats statstable( _self, itr->quantity.symbol.code().raw() );
+      const auto& st = statstable.get( itr->quantity.symbol.code().raw(), "token with symbol does not exist" );
       action(permission_level{ _self, name("active") },
-       name("eosio.token"), name("transfer"),
-       std::make_tuple( _self, itr->to, itr->bounty, itr->memo)
+       st.bounty_contract, name("transfer"),
+       std::make_tuple( _self, itr->to, itr->bounty, memo_text( itr->memo ))
       ).send();
+      SEND_INLINE_ACTION( *this, logpayout, { {_self, "active"_n} },
+        { itr->pk, itr->to, itr->bounty }
+      );
+      auto& q = metrics_for( m, st );
+      if( q.payout_count > 0 ) {
+        q.payout_count--;
+      }
+      q.pending_payouts -= itr->bounty;
+      q.settled_payouts += itr->bounty;
+      cur.payout_key = itr->pk + 1;
+      release_memo( itr->memo );
       itr = payoutstable.erase(itr);
-      done = true;
+      done++;
     }
-    print(done);
-    for(auto itr = rewardstable.begin(); itr != rewardstable.end() && !done;) {
-      print("processing reward\n"); 
-      print(itr->to); 
-      stats statstable( _self, itr->quantity.symbol.code().raw() );
-      auto existing = statstable.find(  itr->quantity.symbol.code().raw() );
+    m.payout_due = itr == payoutstable.end() ? 0 : itr->time;
+    //rewards are keyed in the order they were locked, so the first one still locked ends the run.
+    //the matured ones are gathered first and their amounts worked out in one pass
+    std::vector<payouts::const_iterator> due;
+    std::vector<int64_t> amounts;
+    itr = rewardstable.lower_bound(cur.reward_key);
+    for(; itr != rewardstable.end() && done + due.size() < max_items; ++itr) {
+      if(now() < itr->time + policy::lock_period()) {
+        break;
+      }
+      due.push_back( itr );
+      amounts.push_back( itr->quantity.amount );
+    }
+    std::vector<int64_t> paid( due.size() ), cuts( due.size() ), minted( due.size() );
+    settle_amounts( amounts.data(), paid.data(), cuts.data(), minted.data(), due.size() );
+
+    for( size_t i = 0; i < due.size(); i++ ) {
+      const auto& r = *due[i];
+      stats statstable( _self, r.quantity.symbol.code().raw() );
+      auto existing = statstable.find(  r.quantity.symbol.code().raw() );
       eosio_assert( existing != statstable.end(), "token with symbol does not exist, create token before issue" );
       const auto& st = *existing;
 
-      if(now() < itr->time + 86400) {
-	itr++;
-	continue;
-      }
-
-      asset payout_asset = asset((uint64_t)4, itr->quantity.symbol);
-      payout_asset.amount = itr->quantity.amount*1009/1000;
-      add_balance( itr->to, payout_asset, _self );
+      asset payout_asset = asset( paid[i], r.quantity.symbol );
+      add_balance( r.to, payout_asset, _self );
 
-      asset vote_asset = asset((uint64_t)4, itr->quantity.symbol);
-      vote_asset.amount = (itr->quantity.amount*1001/1000)-itr->quantity.amount;
-      add_balance( itr->vote, vote_asset, _self );
+      asset vote_asset = asset( cuts[i], r.quantity.symbol );
+      add_balance( r.vote, vote_asset, _self );
 
-      asset add_asset = asset((uint64_t)4, itr->quantity.symbol);
-      add_asset.amount = payout_asset.amount + vote_asset.amount - itr->quantity.amount;
+      asset add_asset = asset( minted[i], r.quantity.symbol );
       statstable.modify( st, same_payer, [&]( auto& s ) {
          s.supply += add_asset;
       });
+      SEND_INLINE_ACTION( *this, logsettle, { {_self, "active"_n} },
+        { r.pk, r.to, r.vote, payout_asset, vote_asset }
+      );
 
-      itr = rewardstable.erase(itr);
-      done = true;
+      auto& q = metrics_for( m, st );
+      if( q.reward_count > 0 ) {
+        q.reward_count--;
+      }
+      q.pending_rewards -= r.quantity;
+      q.settled_rewards += r.quantity;
+
+      sub_maturity( r.quantity, r.time + policy::lock_period() );
+      cur.reward_key = r.pk + 1;
+      name owner = r.to;
+      asset locked = r.quantity;
+      release_memo( r.memo );
+      rewardstable.erase( due[i] );
+      sub_pending( owner, locked, payout_asset );
+      done++;
     }
-    print(done);
-    transaction out{};
-    out.actions.emplace_back(permission_level{_self, name("active")}, _self, name("pay"), std::make_tuple());
-    out.delay_sec = 60;
-    out.send(0, _self, true);
+    m.reward_due = itr == rewardstable.end() ? 0 : itr->time + policy::lock_period();
+    if( done > 0 ) {
+      m.lastcrank = now();
+      settlement.set( cur, _self );
+      queues.set( m, _self );
+    }
+    return done;
+}
+
+//the log actions do nothing, they are sent inline so indexers can read settlement
+//events from the action traces with a fixed binary layout
+void token::logreward( uint64_t key, name to, name vote, asset quantity, uint64_t content, uint32_t maturity ) {
+    require_auth( _self );
+}
+
+void token::logretire( uint64_t key, name to, asset quantity, asset bounty ) {
+    require_auth( _self );
+}
+
+void token::logpayout( uint64_t key, name to, asset bounty ) {
+    require_auth( _self );
+}
+
+void token::logsettle( uint64_t key, name to, name vote, asset payout, asset cut ) {
+    require_auth( _self );
+}
+
+//the bounty is topped up by transferring to this contract from the token's bounty_contract,
+//with the token symbol as memo (an empty memo means the bounty and token symbols match)
+void token::ontransfer( name from, name to, asset quantity, string memo )
+{
+    if( to != _self || from == _self ) {
+      return;
+    }
+
+    //transfers from an account some token takes its bounty from have to top one up, anything
+    //else sent to the contract is accepted as it is
+    bounties sources( _self, _self.value );
+    bool source = sources.find( _code.value ) != sources.end();
+
+    symbol_code sym = quantity.symbol.code();
+    if( !memo.empty() ) {
+      bool valid = memo.size() <= 7;
+      for( char c : memo ) {
+        valid = valid && c >= 'A' && c <= 'Z';
+      }
+      if( !valid ) {
+        eosio_assert( !source, "bounty memo must be a token symbol" );
+        return;
+      }
+      sym = symbol_code( memo );
+    }
+
+    stats statstable( _self, sym.raw() );
+    auto existing = statstable.find( sym.raw() );
+    if( existing == statstable.end() || existing->bounty_contract != _code ) {
+      eosio_assert( !source, existing == statstable.end() ? "bounty memo names an unknown token"
+                                                          : "token takes its bounty from another contract" );
+      return;
+    }
+    const auto& st = *existing;
+
+    eosio_assert( quantity.is_valid(), "invalid quantity" );
+    eosio_assert( quantity.amount > 0, "must transfer positive quantity" );
+    eosio_assert( quantity.symbol == st.bounty.symbol, "bounty symbol mismatch" );
+
+    statstable.modify( st, same_payer, [&]( auto& s ) {
+       s.bounty += quantity;
+    });
 }
 
 void token::transfer( name    from,
@@ -253,7 +557,7 @@ void token::transfer( name    from,
     eosio_assert( quantity.is_valid(), "invalid quantity" );
     eosio_assert( quantity.amount > 0, "must transfer positive quantity" );
     eosio_assert( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
-    eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
+    eosio_assert( memo.size() <= policy::memo_limit(), "memo is too long" );
 
     auto payer = has_auth( to ) ? to : from;
 
@@ -267,15 +571,11 @@ void token::sub_balance( name owner, asset value ) {
    const auto& from = from_acnts.get( value.symbol.code().raw(), "no balance object found" );
    eosio_assert( from.balance.amount >= value.amount, "overdrawn balance" );
 
-   if( from == from_acnts.end() ) {
-      from_acnts.emplace( owner, [&]( auto& a ){
-        a.balance.amount = 1;
-      });
-   } else {
-      from_acnts.modify( from, owner, [&]( auto& a ) {
-	a.balance -= value;
-      });
-   }
+   asset before = from.balance;
+   from_acnts.modify( from, owner, [&]( auto& a ) {
+      a.balance -= value;
+   });
+   commit_balance( owner, before, from.balance );
 }
 
 void token::add_balance( name owner, asset value, name ram_payer )
@@ -286,10 +586,241 @@ void token::add_balance( name owner, asset value, name ram_payer )
       to_acnts.emplace( ram_payer, [&]( auto& a ){
         a.balance = value;
       });
+      commit_balance( owner, asset( 0, value.symbol ), value );
    } else {
+      asset before = to->balance;
       to_acnts.modify( to, same_payer, [&]( auto& a ) {
         a.balance += value;
       });
+      commit_balance( owner, before, to->balance );
+   }
+}
+
+//keeps the symbol's commitment row in step with one balance going from before to after
+void token::commit_balance( name owner, const asset& before, const asset& after )
+{
+   commitments commitment( _self, after.symbol.code().raw() );
+   auto c = commitment.get_or_default( commitment_state{ asset( 0, after.symbol ) } );
+   if( owner.value >= c.counted_to ) {
+      //a backfill page still to come reads this balance as it is then
+      return;
+   }
+   c.held += after - before;
+   c.holders += ( after.amount != 0 ) - ( before.amount != 0 );
+   c.digest += balance_mix( owner.value, after.amount ) - balance_mix( owner.value, before.amount );
+   commitment.set( c, _self );
+}
+
+//the row of a token whose balances predate it starts out wrong, as balance changes move it from
+//zero. A backfill recounts it from nothing: the first page clears the row, each page adds the
+//balances of owners above the last one counted, and balance changes of owners not yet counted
+//are left to their page. Owners come from get_table_by_scope on the accounts table, since a
+//contract can't list its own scopes
+void token::backfill( symbol_code sym, const std::vector<name>& owners, bool last )
+{
+   require_auth( _self );
+   stats statstable( _self, sym.raw() );
+   const auto& st = statstable.get( sym.raw(), "token with symbol does not exist" );
+   add_bounty_source( st.bounty_contract );
+
+   commitments commitment( _self, sym.raw() );
+   auto c = commitment.get_or_default( commitment_state{ asset( 0, st.supply.symbol ) } );
+   if( c.counted_to == std::numeric_limits<uint64_t>::max() ) {
+      c = commitment_state{ asset( 0, st.supply.symbol ), 0, 0, 0 };
+   }
+   for( auto owner : owners ) {
+      eosio_assert( owner.value >= c.counted_to, "owners must be ascending and not yet counted" );
+      accounts acnts( _self, owner.value );
+      auto a = acnts.find( sym.raw() );
+      if( a != acnts.end() ) {
+         c.held += a->balance;
+         c.holders += a->balance.amount != 0;
+         c.digest += balance_mix( owner.value, a->balance.amount );
+      }
+      c.counted_to = owner.value == std::numeric_limits<uint64_t>::max() ? owner.value : owner.value + 1;
+   }
+   if( last ) {
+      c.counted_to = std::numeric_limits<uint64_t>::max();
+   }
+   commitment.set( c, _self );
+}
+
+void token::add_bounty_source( name contract )
+{
+   bounties sources( _self, _self.value );
+   if( sources.find( contract.value ) == sources.end() ) {
+      sources.emplace( _self, [&]( auto& b ) {
+         b.contract = contract;
+      });
+   }
+}
+
+//queue rows keep a reference to their memo, 0 meaning none. Building with
+//DCONNECT_DROP_MEMOS discards memos instead of storing them.
+uint64_t token::intern_memo( const string& memo )
+{
+#ifdef DCONNECT_DROP_MEMOS
+   return 0;
+#else
+   if( memo.empty() ) {
+      return 0;
+   }
+   capi_checksum256 hash;
+   sha256( memo.data(), memo.size(), &hash );
+   uint64_t id;
+   memcpy( &id, hash.hash, sizeof(id) );
+   //0 is the empty memo. A row is always found by the hash of its text, never by probing past
+   //another row, so releasing one memo can't hide the row of another
+   id = std::max<uint64_t>( id, 1 );
+
+   memos memotable( _self, _self.value );
+   auto m = memotable.find( id );
+   if( m == memotable.end() ) {
+      memotable.emplace( _self, [&]( auto& a ){
+        a.id = id;
+        a.text = memo;
+        a.refs = 1;
+      });
+   } else {
+      eosio_assert( m->text == memo, "memo hash collision" );
+      memotable.modify( m, same_payer, [&]( auto& a ) {
+        a.refs++;
+      });
+   }
+   return id;
+#endif
+}
+
+string token::memo_text( uint64_t id )
+{
+   if( id == 0 ) {
+      return string();
+   }
+   memos memotable( _self, _self.value );
+   auto m = memotable.find( id );
+   return m == memotable.end() ? string() : m->text;
+}
+
+void token::release_memo( uint64_t id )
+{
+   if( id == 0 ) {
+      return;
+   }
+   memos memotable( _self, _self.value );
+   auto m = memotable.find( id );
+   if( m == memotable.end() ) {
+      return;
+   }
+   if( m->refs <= 1 ) {
+      memotable.erase( m );
+   } else {
+      memotable.modify( m, same_payer, [&]( auto& a ) {
+        a.refs--;
+      });
+   }
+}
+
+void token::add_pending( name owner, asset value, asset payout, uint32_t maturity )
+{
+   pendings pendingtable( _self, owner.value );
+   auto p = pendingtable.find( value.symbol.code().raw() );
+   if( p == pendingtable.end() ) {
+      pendingtable.emplace( _self, [&]( auto& a ){
+        a.locked = value;
+        a.expected = payout;
+        a.count = 1;
+        a.next_maturity = maturity;
+      });
+   } else {
+      pendingtable.modify( p, same_payer, [&]( auto& a ) {
+        a.locked += value;
+        a.expected += payout;
+        a.count++;
+      });
+   }
+}
+
+//called once the settled reward is erased, so the owner's first remaining reward is the next to mature
+void token::sub_pending( name owner, asset value, asset payout )
+{
+   pendings pendingtable( _self, owner.value );
+   auto p = pendingtable.find( value.symbol.code().raw() );
+   if( p == pendingtable.end() ) {
+      return;
+   }
+   if( p->count <= 1 ) {
+      pendingtable.erase( p );
+      return;
+   }
+
+   payouts rewardstable( _self, name("rewards").value );
+   auto byowner = rewardstable.get_index<"byowner"_n>();
+   uint32_t next = 0;
+   for( auto r = byowner.lower_bound( owner.value ); r != byowner.end() && r->to == owner; ++r ) {
+      if( r->quantity.symbol == value.symbol ) {
+         next = r->time + policy::lock_period();
+         break;
+      }
+   }
+   pendingtable.modify( p, same_payer, [&]( auto& a ) {
+     a.locked -= value;
+     a.expected -= payout;
+     a.count--;
+     a.next_maturity = next;
+   });
+}
+
+token::queue_metrics& token::metrics_for( metrics_state& m, const currency_stats& st )
+{
+   for( auto& q : m.queues ) {
+      if( q.sym == st.supply.symbol.code() ) {
+         return q;
+      }
+   }
+   m.queues.push_back( queue_metrics{} );
+   auto& q = m.queues.back();
+   q.sym = st.supply.symbol.code();
+   q.pending_rewards = asset( 0, st.supply.symbol );
+   q.settled_rewards = asset( 0, st.supply.symbol );
+   q.pending_payouts = asset( 0, st.bounty.symbol );
+   q.settled_payouts = asset( 0, st.bounty.symbol );
+   return q;
+}
+
+void token::add_maturity( asset value, uint32_t maturity )
+{
+   buckets bucketstable( _self, value.symbol.code().raw() );
+   uint32_t start = maturity - maturity % bucket_span;
+   auto b = bucketstable.find( start );
+   if( b == bucketstable.end() ) {
+      bucketstable.emplace( _self, [&]( auto& a ){
+        a.start = start;
+        a.count = 1;
+        a.total = value;
+      });
+   } else {
+      bucketstable.modify( b, same_payer, [&]( auto& a ) {
+        a.count++;
+        a.total += value;
+      });
+   }
+}
+
+//rewards locked before buckets existed have no header, so a missing bucket is not an error
+void token::sub_maturity( asset value, uint32_t maturity )
+{
+   buckets bucketstable( _self, value.symbol.code().raw() );
+   auto b = bucketstable.find( maturity - maturity % bucket_span );
+   if( b == bucketstable.end() ) {
+      return;
+   }
+   if( b->count <= 1 ) {
+      bucketstable.erase( b );
+   } else {
+      bucketstable.modify( b, same_payer, [&]( auto& a ) {
+        a.count--;
+        a.total -= value;
+      });
    }
 }
 
@@ -322,6 +853,108 @@ void token::close( name owner, const symbol& symbol )
    acnts.erase( it );
 }
 
+#ifdef DCONNECT_RAW_DISPATCH
+//transfer, reward and retire read their packed arguments straight out of the action
+//data, so oversized memos and malformed payloads fail before any copy or table access
+struct raw_reader {
+   const char* pos;
+   const char* end;
+
+   template<typename T>
+   T read() {
+      eosio_assert( size_t(end - pos) >= sizeof(T), "read past end of action data" );
+      T value;
+      memcpy( &value, pos, sizeof(T) );
+      pos += sizeof(T);
+      return value;
+   }
+
+   name read_name() { return name( read<uint64_t>() ); }
+
+   asset read_asset() {
+      asset value;
+      value.amount = read<int64_t>();
+      value.symbol = symbol( read<uint64_t>() );
+      eosio_assert( value.is_valid(), "invalid quantity" );
+      eosio_assert( value.amount > 0, "must use positive quantity" );
+      return value;
+   }
+
+   //a varuint32 length followed by the bytes, returned as a view into the action data
+   std::string_view read_memo() {
+      uint32_t size = 0;
+      uint8_t shift = 0;
+      uint8_t b;
+      do {
+         b = read<uint8_t>();
+         size |= uint32_t( b & 0x7f ) << shift;
+         shift += 7;
+      } while( ( b & 0x80 ) && shift < 35 );
+      eosio_assert( size <= policy::memo_limit(), "memo is too long" );
+      eosio_assert( size_t(end - pos) >= size, "read past end of action data" );
+      std::string_view memo( pos, size );
+      pos += size;
+      return memo;
+   }
+
+   void finish() { eosio_assert( pos == end, "unexpected trailing action data" ); }
+};
+
+bool raw_dispatch( uint64_t receiver, uint64_t code, uint64_t action ) {
+   if( action != name("transfer").value && action != name("reward").value && action != name("retire").value ) {
+      return false;
+   }
+   //the largest valid payload is a reward with a 256 byte memo
+   constexpr size_t max_size = 512;
+   char buffer[max_size];
+   size_t size = action_data_size();
+   eosio_assert( size <= max_size, "action data too large" );
+   read_action_data( buffer, size );
+   raw_reader r{ buffer, buffer + size };
+   token contract( name(receiver), name(code), datastream<const char*>( buffer, size ) );
+
+   if( action == name("transfer").value ) {
+      name from = r.read_name();
+      name to = r.read_name();
+      asset quantity = r.read_asset();
+      std::string_view memo = r.read_memo();
+      r.finish();
+      contract.transfer( from, to, quantity, string( memo ) );
+   } else if( action == name("reward").value ) {
+      name to = r.read_name();
+      name vote = r.read_name();
+      asset quantity = r.read_asset();
+      std::string_view memo = r.read_memo();
+      int64_t content = r.read<int64_t>();
+      r.finish();
+      contract.reward( to, vote, quantity, string( memo ), content );
+   } else {
+      name to = r.read_name();
+      asset quantity = r.read_asset();
+      std::string_view memo = r.read_memo();
+      r.finish();
+      contract.retire( to, quantity, string( memo ) );
+   }
+   return true;
+}
+#endif
+
 } /// namespace eosio
 
-EOSIO_DISPATCH( eosio::token, (create)(issue)(transfer)(open)(close)(reward)(retire)(pay) )
+extern "C" {
+   void apply( uint64_t receiver, uint64_t code, uint64_t action ) {
+      eosio::policy::reset();
+      if( code == receiver ) {
+#ifdef DCONNECT_RAW_DISPATCH
+         if( eosio::raw_dispatch( receiver, code, action ) ) {
+            return;
+         }
+#endif
+         switch( action ) {
+            EOSIO_DISPATCH_HELPER( eosio::token, (create)(setconfig)(issue)(transfer)(open)(close)(reward)(retire)(importrows)(backfill)(pay)(crank)(logreward)(logretire)(logpayout)(logsettle) )
+         }
+      } else if( action == eosio::name("transfer").value ) {
+         eosio::execute_action( eosio::name(receiver), eosio::name(code), &eosio::token::ontransfer );
+      }
+   }
+}
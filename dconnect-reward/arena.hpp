@@ -0,0 +1,47 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifndef DCONNECT_ARENA_SIZE
+#define DCONNECT_ARENA_SIZE 65536
+#endif
+
+//contract memory is thrown away after every action, so allocations are
+//bumped out of a fixed buffer and never freed. Requests that don't fit
+//in what is left of the buffer fall back to malloc.
+namespace eosio { namespace arena {
+
+   alignas(16) static char buffer[DCONNECT_ARENA_SIZE];
+   static size_t used = 0;
+
+   inline void* allocate( size_t size ) {
+      size = ( size + 15 ) & ~size_t(15);
+      if( size <= DCONNECT_ARENA_SIZE - used ) {
+         void* p = buffer + used;
+         used += size;
+         return p;
+      }
+      return malloc( size );
+   }
+
+   inline void release( void* p ) {
+      char* c = static_cast<char*>( p );
+      if( c != nullptr && ( c < buffer || c >= buffer + DCONNECT_ARENA_SIZE ) ) {
+         free( p );
+      }
+   }
+
+} } /// namespace eosio::arena
+
+void* operator new( size_t size ) { return eosio::arena::allocate( size ); }
+void* operator new[]( size_t size ) { return eosio::arena::allocate( size ); }
+void operator delete( void* p ) noexcept { eosio::arena::release( p ); }
+void operator delete[]( void* p ) noexcept { eosio::arena::release( p ); }
+void operator delete( void* p, size_t ) noexcept { eosio::arena::release( p ); }
+void operator delete[]( void* p, size_t ) noexcept { eosio::arena::release( p ); }
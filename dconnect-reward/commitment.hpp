@@ -0,0 +1,25 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <cstdint>
+
+//no eosiolib in here, an auditor recomputes the commitment off chain from the accounts rows
+namespace eosio {
+
+constexpr uint64_t balance_mix_round( uint64_t z ) {
+   z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+   z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+   return z ^ ( z >> 31 );
+}
+
+//one balance's share of a symbol's digest. The digest is the wrapping sum of these over every
+//accounts row, so a change in one balance updates it without reading any other row. A zero
+//balance adds nothing, which keeps open and close out of it
+constexpr uint64_t balance_mix( uint64_t owner, int64_t amount ) {
+   return amount == 0 ? 0 : balance_mix_round( owner ^ balance_mix_round( (uint64_t)amount + 0x9e3779b97f4a7c15ull ) );
+}
+
+}
@@ -5,9 +5,14 @@
 #pragma once
 
 #include <eosiolib/asset.hpp>
+#include <eosiolib/crypto.h>
 #include <eosiolib/eosio.hpp>
+#include <eosiolib/singleton.hpp>
 #include <eosiolib/transaction.hpp>
 
+#include "policy.hpp"
+
+#include <limits>
 #include <string>
 
 namespace eosiosystem {
@@ -32,9 +37,37 @@ namespace eosio {
 
          [[eosio::action]]
          void issue( name to, asset quantity, string memo );
+         [[eosio::action]]
+         void setconfig( uint32_t lock_period, int64_t payout_rate, int64_t vote_rate,
+                         int64_t rate_base, uint32_t memo_limit, int32_t precision );
+
+         [[eosio::action]]
+         void importrows( name table, const std::vector<char>& rows );
+
+         //counts the balances of a token deployed before the commitment row, a page of owners
+         //at a time in ascending order; last marks the final page. Also records the token's
+         //bounty_contract, which tokens created before the bounties table lack
+         [[eosio::action]]
+         void backfill( symbol_code sym, const std::vector<name>& owners, bool last );
+
          [[eosio::action]]
          void pay( );
 
+         [[eosio::action]]
+         void crank( uint32_t max_items );
+
+         [[eosio::action]]
+         void logreward( uint64_t key, name to, name vote, asset quantity, uint64_t content, uint32_t maturity );
+
+         [[eosio::action]]
+         void logretire( uint64_t key, name to, asset quantity, asset bounty );
+
+         [[eosio::action]]
+         void logpayout( uint64_t key, name to, asset bounty );
+
+         [[eosio::action]]
+         void logsettle( uint64_t key, name to, name vote, asset payout, asset cut );
+
          [[eosio::action]]
          void reward( name to, name vote, asset quantity, string memo, int64_t content);
 
@@ -53,6 +86,10 @@ namespace eosio {
          [[eosio::action]]
          void close( name owner, const symbol& symbol );
 
+         //notification handler, credits transfers from a bounty_contract to that token's bounty.
+         //A transfer from any token's bounty_contract has to name a token that takes it, or it fails
+         void ontransfer( name from, name to, asset quantity, string memo );
+
          static asset get_supply( name token_contract_account, symbol_code sym_code )
          {
             stats statstable( token_contract_account, sym_code.raw() );
@@ -67,7 +104,39 @@ namespace eosio {
             return ac.balance;
          }
 
-      private:
+         //sum of an owner's rows in the "rewards" or "payouts" queue, found through the byowner index
+         static asset get_queued( name token_contract_account, name queue, name owner, symbol sym )
+         {
+            payouts queuetable( token_contract_account, queue.value );
+            auto byowner = queuetable.get_index<"byowner"_n>();
+            asset sum( 0, sym );
+            for( auto itr = byowner.lower_bound( owner.value ); itr != byowner.end() && itr->to == owner; ++itr ) {
+               if( itr->quantity.symbol == sym ) {
+                  sum += itr->quantity;
+               }
+            }
+            return sum;
+         }
+
+         static asset get_locked( name token_contract_account, name owner, symbol sym )
+         {
+            pendings pendingtable( token_contract_account, owner.value );
+            auto p = pendingtable.find( sym.code().raw() );
+            return p == pendingtable.end() ? asset( 0, sym ) : p->locked;
+         }
+
+         //amount of locked rewards maturing in the bucket that contains the given time
+         static asset get_maturing( name token_contract_account, symbol sym, uint32_t time )
+         {
+            buckets bucketstable( token_contract_account, sym.code().raw() );
+            auto b = bucketstable.find( time - time % bucket_span );
+            return b == bucketstable.end() ? asset( 0, sym ) : b->total;
+         }
+
+         static constexpr uint32_t bucket_span = 3600;
+
+         //the rows are public so host builds can unpack them with the contract's own types,
+         //as the tests do to check the off-chain views in tools/common/rows.hpp
          struct [[eosio::table]] account {
             asset    balance;
             uint64_t primary_key()const { return balance.symbol.code().raw(); }
@@ -89,31 +158,130 @@ namespace eosio {
 	    uint64_t pk;
             asset bounty;
 	    name to;
-	    string memo;
+	    uint64_t memo;
             uint32_t time;
             asset quantity;
             name vote;
             uint64_t content;
 
             uint64_t primary_key() const { return  pk; }
+            uint64_t by_owner() const { return to.value; }
          };
 	   
          struct [[eosio::table]] total {
 	    uint64_t pk;
-	    name name;
+	    eosio::name name;
             uint32_t time;
             asset quantity;
             uint64_t content;
+            uint64_t hot;
             uint64_t primary_key() const { return  pk; }
+            uint64_t by_hot() const { return hot; }
          };
 	   
+         //memo text shared by queue rows, keyed by a hash of the text
+         struct [[eosio::table]] memo_entry {
+            uint64_t id;
+            string text;
+            uint64_t refs;
+
+            uint64_t primary_key() const { return id; }
+         };
+
+         //a user's locked rewards in one symbol, scoped by user
+         struct [[eosio::table]] pending {
+            asset locked;
+            asset expected;
+            uint64_t count;
+            uint32_t next_maturity;
+
+            uint64_t primary_key() const { return locked.symbol.code().raw(); }
+         };
+
+         //rewards maturing within one bucket_span, scoped by symbol and keyed by the span's start
+         struct [[eosio::table]] bucket {
+            uint32_t start;
+            uint64_t count;
+            asset total;
+
+            uint64_t primary_key() const { return start; }
+         };
+
+         //an account some token takes its bounty from, scoped by the contract
+         struct [[eosio::table]] bounty_source {
+            name contract;
+
+            uint64_t primary_key() const { return contract.value; }
+         };
+
+         //where the last settlement stopped, the next one resumes from these keys
+         struct [[eosio::table("cursor")]] cursor_state {
+            uint64_t reward_key = 0;
+            uint64_t payout_key = 0;
+         };
+
+         struct queue_metrics {
+            symbol_code sym;
+            uint64_t reward_count = 0;
+            asset pending_rewards;
+            asset settled_rewards;
+            uint64_t payout_count = 0;
+            asset pending_payouts;
+            asset settled_payouts;
+         };
+
+         //queue depth and settlement progress per symbol, readable in one row
+         struct [[eosio::table("metrics")]] metrics_state {
+            std::vector<queue_metrics> queues;
+            uint32_t reward_due = 0;
+            uint32_t payout_due = 0;
+            uint32_t lastcrank = 0;
+         };
+
+         //every balance in one symbol, scoped by symbol: what they add up to, how many are not zero,
+         //and the wrapping sum of balance_mix( owner, amount ) over them. Only owners below
+         //counted_to are in it, which is all of them unless a backfill is under way
+         struct [[eosio::table("commitment")]] commitment_state {
+            asset held;
+            uint64_t holders = 0;
+            uint64_t digest = 0;
+            uint64_t counted_to = std::numeric_limits<uint64_t>::max();
+         };
+
          typedef eosio::multi_index< "accounts"_n, account > accounts;
          typedef eosio::multi_index< "stat"_n, currency_stats > stats;
-         typedef eosio::multi_index< "payouts"_n, payout> payouts;
+         typedef eosio::multi_index< "payouts"_n, payout,
+            indexed_by< "byowner"_n, const_mem_fun<payout, uint64_t, &payout::by_owner> >
+         > payouts;
          typedef eosio::multi_index< "totals"_n, total> totals;
+         typedef eosio::multi_index< "contents"_n, total,
+            indexed_by< "byhot"_n, const_mem_fun<total, uint64_t, &total::by_hot> >
+         > contents;
+         typedef eosio::multi_index< "pending"_n, pending> pendings;
+         typedef eosio::multi_index< "memos"_n, memo_entry> memos;
+         typedef eosio::multi_index< "buckets"_n, bucket> buckets;
+         typedef eosio::multi_index< "bounties"_n, bounty_source> bounties;
+         typedef eosio::singleton< "cursor"_n, cursor_state> cursor;
+         typedef eosio::singleton< "metrics"_n, metrics_state> metrics;
+         typedef eosio::singleton< "commitment"_n, commitment_state> commitments;
 
+      private:
          void sub_balance( name owner, asset value );
          void add_balance( name owner, asset value, name ram_payer );
+         void commit_balance( name owner, const asset& before, const asset& after );
+         void add_bounty_source( name contract );
+         uint64_t intern_memo( const string& memo );
+         string memo_text( uint64_t id );
+         void release_memo( uint64_t id );
+         void add_pending( name owner, asset value, asset payout, uint32_t maturity );
+         void sub_pending( name owner, asset value, asset payout );
+         void add_maturity( asset value, uint32_t maturity );
+         void sub_maturity( asset value, uint32_t maturity );
+         uint32_t settle( uint32_t max_items );
+         template<typename Table, typename Row, typename F>
+         void import_table( datastream<const char*>& ds, F&& imported );
+         static queue_metrics& metrics_for( metrics_state& m, const currency_stats& st );
+         static void settle_amounts( const int64_t* quantity, int64_t* payout, int64_t* cut, int64_t* minted, size_t n );
    };
 
 }
@@ -0,0 +1,89 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+//no eosiolib in here, the off-chain tools rank content with the same scores
+namespace eosio {
+
+//hot scores are log2( sum of amount * 2^(time / hot_halflife) ) in 32.32 fixed point,
+//older rewards weigh half as much per halflife without ever rewriting old rows
+constexpr uint32_t hot_halflife = 86400;
+constexpr uint64_t hot_one = 1ull << 32;
+constexpr unsigned __int128 hot_unit = (unsigned __int128)1 << 62;
+
+constexpr unsigned __int128 hot_isqrt( unsigned __int128 x ) {
+   unsigned __int128 r = x, y = ( x + 1 ) / 2;
+   while( y < r ) {
+      r = y;
+      y = ( r + x / r ) / 2;
+   }
+   return r;
+}
+
+//root[i] is 2^(2^-i) with 62 fractional bits
+struct hot_roots {
+   uint64_t root[33] = {};
+   constexpr hot_roots() {
+      unsigned __int128 r = hot_unit * 2;
+      for( int i = 1; i <= 32; i++ ) {
+         r = hot_isqrt( r * hot_unit );
+         root[i] = (uint64_t)r;
+      }
+   }
+};
+constexpr hot_roots hot_table{};
+
+//log2 of m in [1,2) with 62 fractional bits, returned with 32 fractional bits
+inline uint64_t hot_log2_frac( unsigned __int128 m ) {
+   uint64_t frac = 0;
+   for( int i = 1; i <= 32; i++ ) {
+      m = ( m * m ) / hot_unit;
+      if( m >= hot_unit * 2 ) {
+         m /= 2;
+         frac |= 1ull << ( 32 - i );
+      }
+   }
+   return frac;
+}
+
+inline uint64_t hot_score( int64_t amount, uint32_t time ) {
+   uint64_t x = (uint64_t)amount;
+   int exp = 63 - __builtin_clzll( x );
+   unsigned __int128 m = exp >= 62 ? (unsigned __int128)( x >> ( exp - 62 ) ) : (unsigned __int128)x << ( 62 - exp );
+   return ( (uint64_t)exp << 32 ) + hot_log2_frac( m ) + ( ( (uint64_t)time << 32 ) / hot_halflife );
+}
+
+//log2( 2^a + 2^b ) = max + log2( 1 + 2^-(max - min) )
+inline uint64_t hot_add( uint64_t a, uint64_t b ) {
+   uint64_t hi = std::max( a, b );
+   uint64_t d = hi - std::min( a, b );
+   if( d >= 48 * hot_one ) {
+      return hi;
+   }
+   uint64_t k = d >> 32;
+   uint64_t f = d & ( hot_one - 1 );
+   //2^-d = 2^(1-f) / 2^(k+1), with 2^(1-f) built from the bits of 1-f
+   unsigned __int128 p = hot_unit;
+   uint64_t e = hot_one - f;
+   if( e == hot_one ) {
+      p = hot_unit * 2;
+   } else {
+      for( int i = 1; i <= 32; i++ ) {
+         if( e & ( 1ull << ( 32 - i ) ) ) {
+            p = ( p * hot_table.root[i] ) / hot_unit;
+         }
+      }
+   }
+   unsigned __int128 y = hot_unit + ( p >> ( k + 1 ) );
+   if( y >= hot_unit * 2 ) {
+      return hi + hot_one;
+   }
+   return hi + hot_log2_frac( y );
+}
+
+}
@@ -0,0 +1,97 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <eosiolib/eosio.hpp>
+#include <eosiolib/singleton.hpp>
+
+#ifndef DCONNECT_LOCK_PERIOD
+#define DCONNECT_LOCK_PERIOD 86400
+#endif
+#ifndef DCONNECT_PAYOUT_RATE
+#define DCONNECT_PAYOUT_RATE 1009
+#endif
+#ifndef DCONNECT_VOTE_RATE
+#define DCONNECT_VOTE_RATE 1001
+#endif
+#ifndef DCONNECT_RATE_BASE
+#define DCONNECT_RATE_BASE 1000
+#endif
+#ifndef DCONNECT_MEMO_LIMIT
+#define DCONNECT_MEMO_LIMIT 256
+#endif
+//-1 lets create() accept any precision
+#ifndef DCONNECT_PRECISION
+#define DCONNECT_PRECISION -1
+#endif
+
+namespace eosio {
+
+   //economics chosen when the contract is built, every value folds into the code
+   template<uint32_t LockPeriod, int64_t PayoutRate, int64_t VoteRate, int64_t RateBase, uint32_t MemoLimit, int Precision>
+   struct fixed_policy {
+      static_assert( RateBase > 0, "rate base must be positive" );
+      static_assert( PayoutRate >= RateBase && VoteRate >= RateBase, "rates can't pay out less than was locked" );
+      static_assert( MemoLimit <= 256, "memo limit is at most 256 bytes" );
+
+      static constexpr bool fixed = true;
+      static constexpr uint32_t lock_period() { return LockPeriod; }
+      static constexpr int64_t payout_rate() { return PayoutRate; }
+      static constexpr int64_t vote_rate() { return VoteRate; }
+      static constexpr int64_t rate_base() { return RateBase; }
+      static constexpr uint32_t memo_limit() { return MemoLimit; }
+      static constexpr int precision() { return Precision; }
+      static void reset() {}
+   };
+
+   //a matured reward pays payout_rate / rate_base to its owner and vote_rate / rate_base - 1 to the voter
+   struct [[eosio::table("config")]] policy_config {
+      uint32_t lock_period = DCONNECT_LOCK_PERIOD;
+      int64_t payout_rate = DCONNECT_PAYOUT_RATE;
+      int64_t vote_rate = DCONNECT_VOTE_RATE;
+      int64_t rate_base = DCONNECT_RATE_BASE;
+      uint32_t memo_limit = DCONNECT_MEMO_LIMIT;
+      int32_t precision = DCONNECT_PRECISION;
+   };
+
+   typedef eosio::singleton< "config"_n, policy_config > policy_configs;
+
+   //economics read from the config singleton, which is loaded once per action. A node starts
+   //every action with fresh memory but a host build keeps it, so apply() and setconfig reset it
+   struct runtime_policy {
+      static constexpr bool fixed = false;
+      struct cache {
+         policy_config config;
+         bool loaded = false;
+      };
+      static cache& cached() {
+         static cache c;
+         return c;
+      }
+      static const policy_config& get() {
+         auto& c = cached();
+         if( !c.loaded ) {
+            c.config = policy_configs( name(current_receiver()), current_receiver() ).get_or_default();
+            c.loaded = true;
+         }
+         return c.config;
+      }
+      static void reset() { cached().loaded = false; }
+      static uint32_t lock_period() { return get().lock_period; }
+      static int64_t payout_rate() { return get().payout_rate; }
+      static int64_t vote_rate() { return get().vote_rate; }
+      static int64_t rate_base() { return get().rate_base; }
+      static uint32_t memo_limit() { return get().memo_limit; }
+      static int precision() { return get().precision; }
+   };
+
+#ifdef DCONNECT_RUNTIME_POLICY
+   typedef runtime_policy policy;
+#else
+   typedef fixed_policy< DCONNECT_LOCK_PERIOD, DCONNECT_PAYOUT_RATE, DCONNECT_VOTE_RATE,
+                         DCONNECT_RATE_BASE, DCONNECT_MEMO_LIMIT, DCONNECT_PRECISION > policy;
+#endif
+
+}
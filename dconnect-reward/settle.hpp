@@ -0,0 +1,25 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//no eosiolib in here, the host tests and benchmark run the same settlement arithmetic
+namespace eosio {
+
+//payout to the owner, cut for the voter and supply growth for a batch of matured rewards at
+//the given rates, worked out in 128 bits so large amounts can't overflow them
+inline void settle_batch( const int64_t* quantity, int64_t* payout, int64_t* cut, int64_t* minted, size_t n,
+                          int64_t payout_rate, int64_t vote_rate, int64_t rate_base ) {
+   for( size_t i = 0; i < n; i++ ) {
+      __int128 q = quantity[i];
+      payout[i] = (int64_t)( q * payout_rate / rate_base );
+      cut[i] = (int64_t)( q * vote_rate / rate_base - q );
+      minted[i] = payout[i] + cut[i] - quantity[i];
+   }
+}
+
+}
@@ -0,0 +1,207 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "../common/json.hpp"
+#include "../common/rows.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+//reading payout rows three ways: a get_table_rows response with "json": true, whose assets and
+//names are strings to parse; one with "json": false, whose rows are hex decoded and read through
+//payout_view; and payout_view alone over packed rows, as a snapshot holds them
+using namespace dconnect;
+
+static void usage() {
+   fprintf( stderr,
+            "usage: dconnect-bench-rows [options]\n"
+            "  --rows N              rows per response (default 1000)\n"
+            "  --rounds N            responses decoded per run (default 200)\n" );
+   exit( 2 );
+}
+
+//the fields of a payout row, as a client would keep them
+struct decoded_payout {
+   uint64_t pk = 0;
+   asset bounty;
+   name to;
+   uint64_t memo = 0;
+   uint32_t time = 0;
+   asset quantity;
+   name vote;
+   uint64_t content = 0;
+};
+
+static std::string format_asset( const asset& a ) {
+   std::string digits = std::to_string( a.amount );
+   size_t precision = a.symbol.precision();
+   if( precision > 0 ) {
+      digits.insert( 0, precision + 1 > digits.size() ? precision + 1 - digits.size() : 0, '0' );
+      digits.insert( digits.size() - precision, "." );
+   }
+   return digits + " " + a.symbol.code_string();
+}
+
+//"1.0000 DCN" back into an amount and a symbol
+static asset parse_asset( const std::string& text ) {
+   size_t space = text.find( ' ' );
+   size_t dot = text.find( '.' );
+   uint8_t precision = dot < space ? uint8_t( space - dot - 1 ) : 0;
+   std::string digits = text.substr( 0, space );
+   if( dot < space ) {
+      digits.erase( dot, 1 );
+   }
+   uint64_t code = symbol::code_from_string( std::string_view( text ).substr( space + 1 ) );
+   return asset{ strtoll( digits.c_str(), nullptr, 10 ), symbol{ code << 8 | precision } };
+}
+
+static std::string to_hex( const char* data, size_t size ) {
+   static const char digits[] = "0123456789abcdef";
+   std::string hex;
+   for( size_t i = 0; i < size; i++ ) {
+      hex += digits[uint8_t( data[i] ) >> 4];
+      hex += digits[uint8_t( data[i] ) & 0x0f];
+   }
+   return hex;
+}
+
+static void from_hex( const std::string& hex, std::vector<char>& bytes ) {
+   auto nibble = []( char c ) { return c <= '9' ? c - '0' : c - 'a' + 10; };
+   bytes.resize( hex.size() / 2 );
+   for( size_t i = 0; i < bytes.size(); i++ ) {
+      bytes[i] = char( nibble( hex[2 * i] ) << 4 | nibble( hex[2 * i + 1] ) );
+   }
+}
+
+static decoded_payout from_json( const json_value& row ) {
+   decoded_payout d;
+   d.pk = row["pk"].as_uint64();
+   d.bounty = parse_asset( row["bounty"].text );
+   d.to = name( row["to"].text );
+   d.memo = row["memo"].as_uint64();
+   d.time = uint32_t( row["time"].as_uint64() );
+   d.quantity = parse_asset( row["quantity"].text );
+   d.vote = name( row["vote"].text );
+   d.content = row["content"].as_uint64();
+   return d;
+}
+
+static decoded_payout from_view( const payout_view& v ) {
+   return decoded_payout{ v.pk(), v.bounty(), v.to(), v.memo(), v.time(), v.quantity(), v.vote(), v.content() };
+}
+
+//runs decode once per round over every row, returning ns per row
+template<typename F>
+static double ns_per_row( size_t rows, size_t rounds, F&& decode ) {
+   uint64_t sink = 0;
+   auto start = std::chrono::steady_clock::now();
+   for( size_t r = 0; r < rounds; r++ ) {
+      sink += decode();
+   }
+   double ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+   //keeps the loop from being optimized away
+   if( sink == 42 ) {
+      printf( " " );
+   }
+   return ns / ( double( rounds ) * rows );
+}
+
+int main( int argc, char** argv ) {
+   size_t count = 1000, rounds = 200;
+   for( int i = 1; i < argc; i++ ) {
+      std::string arg = argv[i];
+      if( i + 1 >= argc ) usage();
+      const char* value = argv[++i];
+      if( arg == "--rows" ) count = strtoull( value, nullptr, 10 );
+      else if( arg == "--rounds" ) rounds = strtoull( value, nullptr, 10 );
+      else usage();
+   }
+   if( count == 0 || rounds == 0 ) {
+      usage();
+   }
+
+   const symbol dcn{ symbol::code_from_string( "DCN" ) << 8 | 4 };
+   const symbol bnt{ symbol::code_from_string( "BNT" ) << 8 | 4 };
+   const char* owners[] = { "alice", "bob", "carol", "dave" };
+   std::mt19937_64 rng( 1 );
+   std::vector<char> packed;
+   std::string json_rows = "{\"rows\":[", hex_rows = "{\"rows\":[";
+   for( size_t i = 0; i < count; i++ ) {
+      decoded_payout d{ 1000 + i, asset{ int64_t( rng() % 1000000 ), bnt }, name( owners[rng() % 4] ), rng(), uint32_t( 1600000000 + i ),
+                        asset{ int64_t( rng() % 10000000000ull ), dcn }, name( owners[rng() % 4] ), rng() % 100000 };
+      writer w;
+      w.write( d.pk );
+      w.write_asset( d.bounty );
+      w.write_name( d.to );
+      w.write( d.memo );
+      w.write( d.time );
+      w.write_asset( d.quantity );
+      w.write_name( d.vote );
+      w.write( d.content );
+      packed.insert( packed.end(), w.bytes.begin(), w.bytes.end() );
+
+      const char* sep = i ? "," : "";
+      //nodeos quotes the 64 bit values, as a javascript number could not hold them
+      json_rows += std::string( sep ) + "{\"pk\":\"" + std::to_string( d.pk ) + "\",\"bounty\":\"" + format_asset( d.bounty ) +
+                   "\",\"to\":\"" + d.to.to_string() + "\",\"memo\":\"" + std::to_string( d.memo ) + "\",\"time\":" + std::to_string( d.time ) +
+                   ",\"quantity\":\"" + format_asset( d.quantity ) + "\",\"vote\":\"" + d.vote.to_string() + "\",\"content\":\"" +
+                   std::to_string( d.content ) + "\"}";
+      hex_rows += std::string( sep ) + "\"" + to_hex( w.bytes.data(), w.bytes.size() ) + "\"";
+   }
+   json_rows += "],\"more\":false,\"next_key\":\"\"}";
+   hex_rows += "],\"more\":false,\"next_key\":\"\"}";
+
+   //the three paths have to agree before they are timed
+   auto json_doc = parse_json( json_rows );
+   auto hex_doc = parse_json( hex_rows );
+   std::vector<char> bytes;
+   for( size_t i = 0; i < count; i++ ) {
+      auto a = from_json( json_doc["rows"].items[i] );
+      from_hex( hex_doc["rows"].items[i].text, bytes );
+      auto b = from_view( payout_view( bytes.data(), bytes.size() ) );
+      auto c = from_view( payout_view( packed.data() + i * payout_view::packed_size, payout_view::packed_size ) );
+      if( a.quantity.amount != b.quantity.amount || a.quantity.symbol != b.quantity.symbol || a.to.value != b.to.value ||
+          a.memo != b.memo || a.bounty.amount != c.bounty.amount || b.content != c.content || b.time != c.time ) {
+         fprintf( stderr, "row %zu decodes differently\n", i );
+         return 1;
+      }
+   }
+
+   auto json_path = [&] {
+      uint64_t sum = 0;
+      auto doc = parse_json( json_rows );
+      for( const auto& row : doc["rows"].items ) {
+         sum += from_json( row ).quantity.amount;
+      }
+      return sum;
+   };
+   auto hex_path = [&] {
+      uint64_t sum = 0;
+      std::vector<char> buffer;
+      auto doc = parse_json( hex_rows );
+      for( const auto& row : doc["rows"].items ) {
+         from_hex( row.text, buffer );
+         sum += from_view( payout_view( buffer.data(), buffer.size() ) ).quantity.amount;
+      }
+      return sum;
+   };
+   auto packed_path = [&] {
+      uint64_t sum = 0;
+      for( size_t i = 0; i < count; i++ ) {
+         sum += from_view( payout_view( packed.data() + i * payout_view::packed_size, payout_view::packed_size ) ).quantity.amount;
+      }
+      return sum;
+   };
+
+   printf( "%zu payout rows, %zu rounds\n", count, rounds );
+   printf( "json rows, parsed fields        %8.1f ns per row\n", ns_per_row( count, rounds, json_path ) );
+   printf( "hex rows through payout_view    %8.1f ns per row\n", ns_per_row( count, rounds, hex_path ) );
+   printf( "packed rows through payout_view %8.1f ns per row\n", ns_per_row( count, rounds, packed_path ) );
+   return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include <dconnect-reward/settle.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+//settle_batch against the int64 arithmetic it replaced, over batches of random amounts.
+//The int64 path is only timed on amounts small enough that it doesn't overflow
+static void usage() {
+   fprintf( stderr,
+            "usage: dconnect-bench-settle [options]\n"
+            "  --batch N             amounts per call (default 64)\n"
+            "  --rounds N            calls per run (default 200000)\n" );
+   exit( 2 );
+}
+
+static void int64_batch( const int64_t* quantity, int64_t* payout, int64_t* cut, int64_t* minted, size_t n ) {
+   for( size_t i = 0; i < n; i++ ) {
+      payout[i] = quantity[i] * 1009 / 1000;
+      cut[i] = quantity[i] * 1001 / 1000 - quantity[i];
+      minted[i] = payout[i] + cut[i] - quantity[i];
+   }
+}
+
+template<typename F>
+static double ns_per_amount( const std::vector<int64_t>& amounts, size_t rounds, F&& batch ) {
+   size_t n = amounts.size();
+   std::vector<int64_t> payout( n ), cut( n ), minted( n );
+   int64_t sink = 0;
+   auto start = std::chrono::steady_clock::now();
+   for( size_t r = 0; r < rounds; r++ ) {
+      batch( amounts.data(), payout.data(), cut.data(), minted.data(), n );
+      sink += minted[r % n];
+   }
+   double ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+   //keeps the loop from being optimized away
+   if( sink == 42 ) {
+      printf( " " );
+   }
+   return ns / ( double( rounds ) * n );
+}
+
+int main( int argc, char** argv ) {
+   size_t batch = 64, rounds = 200000;
+   for( int i = 1; i < argc; i++ ) {
+      std::string arg = argv[i];
+      if( i + 1 >= argc ) usage();
+      const char* value = argv[++i];
+      if( arg == "--batch" ) batch = strtoull( value, nullptr, 10 );
+      else if( arg == "--rounds" ) rounds = strtoull( value, nullptr, 10 );
+      else usage();
+   }
+   if( batch == 0 || rounds == 0 ) {
+      usage();
+   }
+
+   std::mt19937_64 rng( 1 );
+   std::vector<int64_t> small( batch ), large( batch );
+   for( size_t i = 0; i < batch; i++ ) {
+      small[i] = 1 + int64_t( rng() % 10000000000ull );
+      large[i] = 1 + int64_t( rng() >> 2 );
+   }
+   auto settle = []( const int64_t* q, int64_t* p, int64_t* c, int64_t* m, size_t n ) {
+      eosio::settle_batch( q, p, c, m, n, 1009, 1001, 1000 );
+   };
+
+   printf( "batch %zu, %zu rounds\n", batch, rounds );
+   printf( "int64, amounts below 10^10     %6.2f ns per amount\n", ns_per_amount( small, rounds, int64_batch ) );
+   printf( "settle_batch, below 10^10      %6.2f ns per amount\n", ns_per_amount( small, rounds, settle ) );
+   printf( "settle_batch, up to 2^62       %6.2f ns per amount\n", ns_per_amount( large, rounds, settle ) );
+   return 0;
+}
@@ -0,0 +1,188 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//a json document read into a tree, enough for an abi file or a get_table_rows response.
+//Numbers keep their text so 64 bit values the node quotes or not come through whole
+namespace dconnect {
+
+   struct json_error : std::runtime_error {
+      using std::runtime_error::runtime_error;
+   };
+
+   struct json_value {
+      enum kind_t { null, boolean, number, string, array, object };
+
+      kind_t kind = null;
+      std::string text;   //a string's contents, a number's digits, or "true" and "false"
+      std::vector<json_value> items;
+      std::vector<std::pair<std::string, json_value>> fields;
+
+      //the field with the given key, or a null value when the object has none
+      const json_value& operator[]( std::string_view key ) const {
+         static const json_value missing;
+         for( const auto& f : fields ) {
+            if( f.first == key ) {
+               return f.second;
+            }
+         }
+         return missing;
+      }
+
+      uint64_t as_uint64() const { return strtoull( text.c_str(), nullptr, 10 ); }
+      int64_t as_int64() const { return strtoll( text.c_str(), nullptr, 10 ); }
+   };
+
+   class json_parser {
+      public:
+         explicit json_parser( std::string_view text ) : s( text ) {}
+
+         json_value parse() {
+            json_value v = value();
+            space();
+            if( pos != s.size() ) {
+               fail( "trailing characters" );
+            }
+            return v;
+         }
+
+      private:
+         json_value value() {
+            space();
+            json_value v;
+            if( pos >= s.size() ) {
+               fail( "unexpected end" );
+            }
+            char c = s[pos];
+            if( c == '{' ) {
+               v.kind = json_value::object;
+               pos++;
+               space();
+               if( peek() == '}' ) {
+                  pos++;
+                  return v;
+               }
+               do {
+                  space();
+                  std::string key = string_body();
+                  space();
+                  expect( ':' );
+                  v.fields.emplace_back( std::move( key ), value() );
+                  space();
+               } while( take( ',' ) );
+               expect( '}' );
+            } else if( c == '[' ) {
+               v.kind = json_value::array;
+               pos++;
+               space();
+               if( peek() == ']' ) {
+                  pos++;
+                  return v;
+               }
+               do {
+                  v.items.push_back( value() );
+                  space();
+               } while( take( ',' ) );
+               expect( ']' );
+            } else if( c == '"' ) {
+               v.kind = json_value::string;
+               v.text = string_body();
+            } else if( c == '-' || ( c >= '0' && c <= '9' ) ) {
+               v.kind = json_value::number;
+               size_t start = pos;
+               while( pos < s.size() && strchr( "+-.eE0123456789", s[pos] ) ) {
+                  pos++;
+               }
+               v.text = std::string( s.substr( start, pos - start ) );
+            } else if( s.substr( pos, 4 ) == "true" || s.substr( pos, 5 ) == "false" ) {
+               v.kind = json_value::boolean;
+               v.text = c == 't' ? "true" : "false";
+               pos += v.text.size();
+            } else if( s.substr( pos, 4 ) == "null" ) {
+               pos += 4;
+            } else {
+               fail( "unexpected character" );
+            }
+            return v;
+         }
+
+         std::string string_body() {
+            expect( '"' );
+            std::string out;
+            while( pos < s.size() && s[pos] != '"' ) {
+               char c = s[pos++];
+               if( c != '\\' ) {
+                  out += c;
+                  continue;
+               }
+               if( pos >= s.size() ) {
+                  break;
+               }
+               char e = s[pos++];
+               switch( e ) {
+                  case 'n': out += '\n'; break;
+                  case 't': out += '\t'; break;
+                  case 'r': out += '\r'; break;
+                  case 'b': out += '\b'; break;
+                  case 'f': out += '\f'; break;
+                  case 'u': {
+                     //abi files and table rows only escape control characters this way
+                     if( pos + 4 > s.size() ) {
+                        fail( "short unicode escape" );
+                     }
+                     out += char( strtoul( std::string( s.substr( pos, 4 ) ).c_str(), nullptr, 16 ) );
+                     pos += 4;
+                     break;
+                  }
+                  default: out += e;
+               }
+            }
+            expect( '"' );
+            return out;
+         }
+
+         void space() {
+            while( pos < s.size() && ( s[pos] == ' ' || s[pos] == '\n' || s[pos] == '\r' || s[pos] == '\t' ) ) {
+               pos++;
+            }
+         }
+
+         char peek() const { return pos < s.size() ? s[pos] : 0; }
+
+         bool take( char c ) {
+            if( peek() == c ) {
+               pos++;
+               return true;
+            }
+            return false;
+         }
+
+         void expect( char c ) {
+            if( !take( c ) ) {
+               fail( std::string( "expected '" ) + c + "'" );
+            }
+         }
+
+         [[noreturn]] void fail( const std::string& what ) const {
+            throw json_error( what + " at offset " + std::to_string( pos ) );
+         }
+
+         std::string_view s;
+         size_t pos = 0;
+   };
+
+   inline json_value parse_json( std::string_view text ) {
+      return json_parser( text ).parse();
+   }
+
+}
@@ -0,0 +1,188 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "serialize.hpp"
+
+//typed views over the contract's packed rows, as get_table_rows returns them with json=false
+//or as a snapshot stores them. Fields are read out of the row bytes on access, so a view
+//costs nothing to make and the bytes must outlive it. The offsets follow the field order of
+//the structs in dconnect-reward.hpp; tools/tests/rows.cpp unpacks every row the contract writes
+//with those structs and fails if a view reads a field differently
+namespace dconnect {
+
+   namespace detail {
+      template<typename T>
+      T load( const char* p ) {
+         T value;
+         memcpy( &value, p, sizeof(T) );
+         return value;
+      }
+
+      inline dconnect::asset load_asset( const char* p ) {
+         return dconnect::asset{ load<int64_t>( p ), dconnect::symbol{ load<uint64_t>( p + 8 ) } };
+      }
+
+      inline void check_size( size_t size, size_t expected, const char* row ) {
+         if( size != expected ) {
+            throw decode_error( std::string( "packed " ) + row + " has the wrong size" );
+         }
+      }
+   }
+
+   //account { asset balance }
+   class account_view {
+      public:
+         static constexpr size_t packed_size = 16;
+
+         account_view( const char* data, size_t size ) : p( data ) { detail::check_size( size, packed_size, "account" ); }
+
+         dconnect::asset balance() const { return detail::load_asset( p ); }
+         uint64_t primary_key() const { return detail::load<uint64_t>( p + 8 ) >> 8; }
+
+      private:
+         const char* p;
+   };
+
+   //currency_stats { asset supply, max_supply; name issuer, bounty_contract; asset bounty;
+   //                 uint32_t lastpay; uint64_t bounty_rate }
+   class currency_stats_view {
+      public:
+         static constexpr size_t packed_size = 76;
+
+         currency_stats_view( const char* data, size_t size ) : p( data ) { detail::check_size( size, packed_size, "currency_stats" ); }
+
+         dconnect::asset supply() const { return detail::load_asset( p ); }
+         dconnect::asset max_supply() const { return detail::load_asset( p + 16 ); }
+         dconnect::name issuer() const { return dconnect::name( detail::load<uint64_t>( p + 32 ) ); }
+         dconnect::name bounty_contract() const { return dconnect::name( detail::load<uint64_t>( p + 40 ) ); }
+         dconnect::asset bounty() const { return detail::load_asset( p + 48 ); }
+         uint32_t lastpay() const { return detail::load<uint32_t>( p + 64 ); }
+         uint64_t bounty_rate() const { return detail::load<uint64_t>( p + 68 ); }
+         uint64_t primary_key() const { return detail::load<uint64_t>( p + 8 ) >> 8; }
+
+      private:
+         const char* p;
+   };
+
+   //payout { uint64_t pk; asset bounty; name to; uint64_t memo; uint32_t time; asset quantity;
+   //         name vote; uint64_t content }, the row of both the rewards and payouts queues
+   class payout_view {
+      public:
+         static constexpr size_t packed_size = 76;
+
+         payout_view( const char* data, size_t size ) : p( data ) { detail::check_size( size, packed_size, "payout" ); }
+
+         uint64_t pk() const { return detail::load<uint64_t>( p ); }
+         dconnect::asset bounty() const { return detail::load_asset( p + 8 ); }
+         dconnect::name to() const { return dconnect::name( detail::load<uint64_t>( p + 24 ) ); }
+         uint64_t memo() const { return detail::load<uint64_t>( p + 32 ); }
+         uint32_t time() const { return detail::load<uint32_t>( p + 40 ); }
+         dconnect::asset quantity() const { return detail::load_asset( p + 44 ); }
+         dconnect::name vote() const { return dconnect::name( detail::load<uint64_t>( p + 60 ) ); }
+         uint64_t content() const { return detail::load<uint64_t>( p + 68 ); }
+         uint64_t primary_key() const { return pk(); }
+
+      private:
+         const char* p;
+   };
+
+   //total { uint64_t pk; name name; uint32_t time; asset quantity; uint64_t content; uint64_t hot },
+   //the row of both the totals and contents tables
+   class total_view {
+      public:
+         static constexpr size_t packed_size = 52;
+
+         total_view( const char* data, size_t size ) : p( data ) { detail::check_size( size, packed_size, "total" ); }
+
+         uint64_t pk() const { return detail::load<uint64_t>( p ); }
+         dconnect::name name() const { return dconnect::name( detail::load<uint64_t>( p + 8 ) ); }
+         uint32_t time() const { return detail::load<uint32_t>( p + 16 ); }
+         dconnect::asset quantity() const { return detail::load_asset( p + 20 ); }
+         uint64_t content() const { return detail::load<uint64_t>( p + 36 ); }
+         uint64_t hot() const { return detail::load<uint64_t>( p + 44 ); }
+         uint64_t primary_key() const { return pk(); }
+
+      private:
+         const char* p;
+   };
+
+   //pending { asset locked, expected; uint64_t count; uint32_t next_maturity }, scoped by owner
+   class pending_view {
+      public:
+         static constexpr size_t packed_size = 44;
+
+         pending_view( const char* data, size_t size ) : p( data ) { detail::check_size( size, packed_size, "pending" ); }
+
+         dconnect::asset locked() const { return detail::load_asset( p ); }
+         dconnect::asset expected() const { return detail::load_asset( p + 16 ); }
+         uint64_t count() const { return detail::load<uint64_t>( p + 32 ); }
+         uint32_t next_maturity() const { return detail::load<uint32_t>( p + 40 ); }
+         uint64_t primary_key() const { return detail::load<uint64_t>( p + 8 ) >> 8; }
+
+      private:
+         const char* p;
+   };
+
+   //bucket { uint32_t start; uint64_t count; asset total }, scoped by symbol code
+   class bucket_view {
+      public:
+         static constexpr size_t packed_size = 28;
+
+         bucket_view( const char* data, size_t size ) : p( data ) { detail::check_size( size, packed_size, "bucket" ); }
+
+         uint32_t start() const { return detail::load<uint32_t>( p ); }
+         uint64_t count() const { return detail::load<uint64_t>( p + 4 ); }
+         dconnect::asset total() const { return detail::load_asset( p + 12 ); }
+         uint64_t primary_key() const { return start(); }
+
+      private:
+         const char* p;
+   };
+
+   //commitment_state { asset held; uint64_t holders, digest, counted_to }, the commitment
+   //singleton scoped by symbol code
+   class commitment_view {
+      public:
+         static constexpr size_t packed_size = 40;
+
+         commitment_view( const char* data, size_t size ) : p( data ) { detail::check_size( size, packed_size, "commitment_state" ); }
+
+         dconnect::asset held() const { return detail::load_asset( p ); }
+         uint64_t holders() const { return detail::load<uint64_t>( p + 16 ); }
+         uint64_t digest() const { return detail::load<uint64_t>( p + 24 ); }
+         uint64_t counted_to() const { return detail::load<uint64_t>( p + 32 ); }
+         uint64_t primary_key() const { return dconnect::name( "commitment" ).value; }
+
+      private:
+         const char* p;
+   };
+
+   //memo_entry { uint64_t id; string text; uint64_t refs }, the one row with a variable size.
+   //The text's length prefix is read once, when the view is made
+   class memo_entry_view {
+      public:
+         memo_entry_view( const char* data, size_t size ) {
+            reader r( data, size );
+            id_ = r.read<uint64_t>();
+            text_ = r.read_string();
+            refs_ = r.read<uint64_t>();
+            if( r.remaining() != 0 ) {
+               throw decode_error( "packed memo_entry has the wrong size" );
+            }
+         }
+
+         uint64_t id() const { return id_; }
+         std::string_view text() const { return text_; }
+         uint64_t refs() const { return refs_; }
+         uint64_t primary_key() const { return id_; }
+
+      private:
+         uint64_t id_;
+         std::string_view text_;
+         uint64_t refs_;
+   };
+
+}
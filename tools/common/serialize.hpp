@@ -0,0 +1,182 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//the eosio binary encoding, as the contract's actions and rows are packed on chain
+namespace dconnect {
+
+   struct name {
+      uint64_t value = 0;
+
+      constexpr name() = default;
+      constexpr explicit name( uint64_t v ) : value( v ) {}
+      constexpr explicit name( std::string_view str ) {
+         for( size_t i = 0; i < str.size() && i < 13; i++ ) {
+            uint64_t c = char_to_value( str[i] );
+            if( i < 12 ) {
+               value |= ( c & 0x1f ) << ( 64 - 5 * ( i + 1 ) );
+            } else {
+               value |= c & 0x0f;
+            }
+         }
+      }
+
+      static constexpr uint64_t char_to_value( char c ) {
+         if( c >= 'a' && c <= 'z' ) return ( c - 'a' ) + 6;
+         if( c >= '1' && c <= '5' ) return ( c - '1' ) + 1;
+         return 0;
+      }
+
+      std::string to_string() const {
+         static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
+         std::string str( 13, '.' );
+         uint64_t tmp = value;
+         for( int i = 0; i <= 12; i++ ) {
+            str[12 - i] = charmap[tmp & ( i == 0 ? 0x0f : 0x1f )];
+            tmp >>= ( i == 0 ? 4 : 5 );
+         }
+         str.erase( str.find_last_not_of( '.' ) + 1 );
+         return str;
+      }
+
+      friend bool operator==( name a, name b ) { return a.value == b.value; }
+      friend bool operator!=( name a, name b ) { return a.value != b.value; }
+      friend bool operator<( name a, name b ) { return a.value < b.value; }
+   };
+
+   //symbol holds the precision in the low byte and the code above it
+   struct symbol {
+      uint64_t value = 0;
+
+      uint64_t code() const { return value >> 8; }
+      uint8_t precision() const { return value & 0xff; }
+
+      std::string code_string() const {
+         std::string str;
+         for( uint64_t c = code(); c; c >>= 8 ) {
+            str += char( c & 0xff );
+         }
+         return str;
+      }
+
+      static uint64_t code_from_string( std::string_view str ) {
+         uint64_t code = 0;
+         for( auto itr = str.rbegin(); itr != str.rend(); ++itr ) {
+            code = ( code << 8 ) | uint8_t( *itr );
+         }
+         return code;
+      }
+
+      friend bool operator==( symbol a, symbol b ) { return a.value == b.value; }
+      friend bool operator!=( symbol a, symbol b ) { return a.value != b.value; }
+   };
+
+   struct asset {
+      int64_t amount = 0;
+      dconnect::symbol symbol;
+   };
+
+   struct decode_error : std::runtime_error {
+      using std::runtime_error::runtime_error;
+   };
+
+   //reads packed values in place, strings come back as views into the buffer
+   class reader {
+      public:
+         reader( const char* data, size_t size ) : pos( data ), end( data + size ) {}
+
+         template<typename T>
+         T read() {
+            need( sizeof(T) );
+            T value;
+            memcpy( &value, pos, sizeof(T) );
+            pos += sizeof(T);
+            return value;
+         }
+
+         dconnect::name read_name() { return dconnect::name( read<uint64_t>() ); }
+         dconnect::symbol read_symbol() { return dconnect::symbol{ read<uint64_t>() }; }
+
+         dconnect::asset read_asset() {
+            dconnect::asset a;
+            a.amount = read<int64_t>();
+            a.symbol = read_symbol();
+            return a;
+         }
+
+         uint32_t read_varuint32() {
+            uint32_t value = 0;
+            uint8_t shift = 0;
+            uint8_t b;
+            do {
+               b = read<uint8_t>();
+               value |= uint32_t( b & 0x7f ) << shift;
+               shift += 7;
+            } while( ( b & 0x80 ) && shift < 35 );
+            return value;
+         }
+
+         std::string_view read_string() {
+            uint32_t size = read_varuint32();
+            need( size );
+            std::string_view str( pos, size );
+            pos += size;
+            return str;
+         }
+
+         size_t remaining() const { return end - pos; }
+         const char* position() const { return pos; }
+
+      private:
+         void need( size_t size ) {
+            if( size_t( end - pos ) < size ) {
+               throw decode_error( "read past end of packed data" );
+            }
+         }
+
+         const char* pos;
+         const char* end;
+   };
+
+   class writer {
+      public:
+         template<typename T>
+         void write( const T& value ) {
+            const char* p = reinterpret_cast<const char*>( &value );
+            bytes.insert( bytes.end(), p, p + sizeof(T) );
+         }
+
+         void write_name( dconnect::name n ) { write( n.value ); }
+
+         void write_asset( const dconnect::asset& a ) {
+            write( a.amount );
+            write( a.symbol.value );
+         }
+
+         void write_varuint32( uint32_t value ) {
+            do {
+               uint8_t b = value & 0x7f;
+               value >>= 7;
+               b |= ( value > 0 ) << 7;
+               bytes.push_back( char( b ) );
+            } while( value );
+         }
+
+         void write_string( std::string_view str ) {
+            write_varuint32( str.size() );
+            bytes.insert( bytes.end(), str.begin(), str.end() );
+         }
+
+         std::vector<char> bytes;
+   };
+
+}
@@ -0,0 +1,92 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "serialize.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <optional>
+#include <string>
+
+//a trace file is a sequence of records, each a trace_header followed by the packed action data
+namespace dconnect {
+
+   struct trace_header {
+      uint32_t size;      //bytes of action data that follow
+      uint32_t time;      //block time in seconds, what now() returned to the action
+      uint64_t account;   //the contract the action was sent to
+      uint64_t action;
+   };
+
+   struct trace {
+      uint64_t offset;    //of the record in the file
+      uint64_t end;       //offset of the next record
+      uint32_t time;
+      dconnect::name account;
+      dconnect::name action;
+      const char* data;
+      uint32_t size;
+   };
+
+   class trace_file {
+      public:
+         explicit trace_file( const std::string& path ) {
+            fd = ::open( path.c_str(), O_RDONLY );
+            if( fd < 0 ) {
+               throw std::runtime_error( "cannot open trace file " + path );
+            }
+            struct stat st;
+            fstat( fd, &st );
+            length = st.st_size;
+            if( length > 0 ) {
+               base = static_cast<const char*>( mmap( nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0 ) );
+               if( base == MAP_FAILED ) {
+                  throw std::runtime_error( "cannot map trace file " + path );
+               }
+               madvise( const_cast<char*>( base ), length, MADV_SEQUENTIAL );
+            }
+         }
+
+         ~trace_file() {
+            if( base && base != MAP_FAILED ) {
+               munmap( const_cast<char*>( base ), length );
+            }
+            if( fd >= 0 ) {
+               ::close( fd );
+            }
+         }
+
+         trace_file( const trace_file& ) = delete;
+         trace_file& operator=( const trace_file& ) = delete;
+
+         //the record at offset, or nothing once the file ends. A record cut short by
+         //a writer that is still appending is treated as the end of the file
+         std::optional<trace> at( uint64_t offset ) const {
+            if( offset + sizeof(trace_header) > length ) {
+               return std::nullopt;
+            }
+            trace_header h;
+            memcpy( &h, base + offset, sizeof(h) );
+            uint64_t end = offset + sizeof(h) + h.size;
+            if( end > length ) {
+               return std::nullopt;
+            }
+            return trace{ offset, end, h.time, dconnect::name( h.account ), dconnect::name( h.action ),
+                          base + offset + sizeof(h), h.size };
+         }
+
+         uint64_t size() const { return length; }
+
+      private:
+         int fd = -1;
+         const char* base = nullptr;
+         uint64_t length = 0;
+   };
+
+}
@@ -0,0 +1,263 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "../indexer/state.hpp"
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <unordered_map>
+
+//the event history as a file of column chunks. The file starts with a columns_header and
+//every chunk is a chunk_header followed by one column_header and its deflated bytes per column.
+//Names and symbols are dictionary encoded per chunk, keys and times are deltas from the row
+//before, and every integer is a zigzag varint, so a chunk can be decoded without the others
+namespace dconnect {
+
+   struct columns_header {
+      char magic[8];
+      uint32_t version;
+      uint32_t reserved;
+   };
+
+   struct chunk_header {
+      uint32_t rows;
+      uint32_t columns;
+      uint64_t size;        //bytes of the column headers and data that follow
+      uint32_t first_time;
+      uint32_t last_time;
+   };
+
+   struct column_header {
+      uint32_t column;
+      uint32_t encoding;
+      uint32_t raw_size;
+      uint32_t size;        //deflated
+   };
+
+   constexpr char columns_magic[8] = { 'd', 'c', 'c', 'o', 'l', 's', 0, 0 };
+   constexpr uint32_t columns_version = 1;
+
+   enum column : uint32_t { type_column, key_column, time_column, to_column, vote_column, quantity_column,
+                            quantity_symbol_column, amount_column, amount_symbol_column, content_column, column_count };
+
+   enum encoding : uint32_t { plain_encoding, delta_encoding, dictionary_encoding };
+
+   inline const char* column_name( uint32_t c ) {
+      static const char* names[] = { "type", "key", "time", "to", "vote", "quantity", "quantity_symbol",
+                                     "amount", "amount_symbol", "content" };
+      return c < column_count ? names[c] : "unknown";
+   }
+
+   inline const char* event_name( uint32_t type ) {
+      static const char* names[] = { "reward", "retire", "payout", "settle" };
+      return type < 4 ? names[type] : "unknown";
+   }
+
+   inline uint64_t zigzag( int64_t v ) { return ( uint64_t( v ) << 1 ) ^ uint64_t( v >> 63 ); }
+   inline int64_t unzigzag( uint64_t v ) { return int64_t( v >> 1 ) ^ -int64_t( v & 1 ); }
+
+   inline void put_varint( std::vector<char>& out, uint64_t v ) {
+      do {
+         uint8_t b = v & 0x7f;
+         v >>= 7;
+         b |= ( v > 0 ) << 7;
+         out.push_back( char( b ) );
+      } while( v );
+   }
+
+   inline uint64_t get_varint( const char*& p, const char* end ) {
+      uint64_t v = 0;
+      for( int shift = 0; shift < 64; shift += 7 ) {
+         if( p == end ) {
+            throw decode_error( "column ends inside a value" );
+         }
+         uint8_t b = *p++;
+         v |= uint64_t( b & 0x7f ) << shift;
+         if( !( b & 0x80 ) ) {
+            return v;
+         }
+      }
+      throw decode_error( "varint too long" );
+   }
+
+   //collects one column of a chunk; buffers are kept across chunks so their size stays at the largest chunk
+   class column_encoder {
+      public:
+         explicit column_encoder( dconnect::encoding e = plain_encoding ) : enc( e ) {}
+
+         void add( uint64_t v ) {
+            switch( enc ) {
+               case plain_encoding:
+                  put_varint( bytes, zigzag( int64_t( v ) ) );
+                  break;
+               case delta_encoding:
+                  put_varint( bytes, zigzag( int64_t( v - last ) ) );
+                  last = v;
+                  break;
+               case dictionary_encoding: {
+                  auto result = ids.try_emplace( v, uint32_t( values.size() ) );
+                  if( result.second ) {
+                     values.push_back( v );
+                  }
+                  put_varint( bytes, result.first->second );
+                  break;
+               }
+            }
+         }
+
+         //the column as stored, a dictionary column leads with its values
+         const std::vector<char>& encoded() {
+            if( enc != dictionary_encoding ) {
+               return bytes;
+            }
+            out.clear();
+            put_varint( out, values.size() );
+            for( uint64_t v : values ) {
+               out.insert( out.end(), reinterpret_cast<const char*>( &v ), reinterpret_cast<const char*>( &v ) + 8 );
+            }
+            out.insert( out.end(), bytes.begin(), bytes.end() );
+            return out;
+         }
+
+         void clear() {
+            bytes.clear();
+            ids.clear();
+            values.clear();
+            last = 0;
+         }
+
+         dconnect::encoding encoding() const { return enc; }
+
+      private:
+         dconnect::encoding enc;
+         std::vector<char> bytes;
+         std::vector<char> out;
+         std::unordered_map<uint64_t, uint32_t> ids;
+         std::vector<uint64_t> values;
+         uint64_t last = 0;
+   };
+
+   class column_decoder {
+      public:
+         column_decoder( dconnect::encoding e, const char* data, size_t size ) : enc( e ), p( data ), end( data + size ) {
+            if( enc == dictionary_encoding ) {
+               uint64_t n = get_varint( p, end );
+               if( n > uint64_t( end - p ) / 8 ) {
+                  throw decode_error( "dictionary larger than its column" );
+               }
+               values.resize( n );
+               memcpy( values.data(), p, n * 8 );
+               p += n * 8;
+            }
+         }
+
+         uint64_t next() {
+            uint64_t v = get_varint( p, end );
+            switch( enc ) {
+               case plain_encoding:
+                  return uint64_t( unzigzag( v ) );
+               case delta_encoding:
+                  last += uint64_t( unzigzag( v ) );
+                  return last;
+               case dictionary_encoding:
+                  if( v >= values.size() ) {
+                     throw decode_error( "dictionary index out of range" );
+                  }
+                  return values[v];
+            }
+            return v;
+         }
+
+      private:
+         dconnect::encoding enc;
+         const char* p;
+         const char* end;
+         std::vector<uint64_t> values;
+         uint64_t last = 0;
+   };
+
+   //writes events as chunks of up to chunk_rows rows, so the writer buffers one chunk however long the history
+   class column_writer {
+      public:
+         column_writer( FILE* out, uint32_t chunk_rows, int level ) : out( out ), chunk_rows( chunk_rows ), level( level ) {
+            columns[type_column] = column_encoder( plain_encoding );
+            columns[key_column] = column_encoder( delta_encoding );
+            columns[time_column] = column_encoder( delta_encoding );
+            columns[to_column] = column_encoder( dictionary_encoding );
+            columns[vote_column] = column_encoder( dictionary_encoding );
+            columns[quantity_column] = column_encoder( plain_encoding );
+            columns[quantity_symbol_column] = column_encoder( dictionary_encoding );
+            columns[amount_column] = column_encoder( plain_encoding );
+            columns[amount_symbol_column] = column_encoder( dictionary_encoding );
+            columns[content_column] = column_encoder( plain_encoding );
+         }
+
+         void add( const event& e ) {
+            if( rows == 0 ) {
+               first_time = e.time;
+            }
+            last_time = e.time;
+            columns[type_column].add( e.type );
+            columns[key_column].add( e.key );
+            columns[time_column].add( e.time );
+            columns[to_column].add( e.to.value );
+            columns[vote_column].add( e.vote.value );
+            columns[quantity_column].add( e.quantity.amount );
+            columns[quantity_symbol_column].add( e.quantity.symbol.value );
+            columns[amount_column].add( e.amount.amount );
+            columns[amount_symbol_column].add( e.amount.symbol.value );
+            columns[content_column].add( e.content );
+            if( ++rows == chunk_rows ) {
+               flush();
+            }
+         }
+
+         void flush() {
+            if( rows == 0 ) {
+               return;
+            }
+            body.clear();
+            for( uint32_t c = 0; c < column_count; c++ ) {
+               const auto& raw = columns[c].encoded();
+               uLongf size = compressBound( raw.size() );
+               deflated.resize( size );
+               if( compress2( reinterpret_cast<Bytef*>( deflated.data() ), &size,
+                              reinterpret_cast<const Bytef*>( raw.data() ), raw.size(), level ) != Z_OK ) {
+                  throw std::runtime_error( "cannot compress a column" );
+               }
+               column_header h{ c, columns[c].encoding(), uint32_t( raw.size() ), uint32_t( size ) };
+               body.insert( body.end(), reinterpret_cast<const char*>( &h ), reinterpret_cast<const char*>( &h + 1 ) );
+               body.insert( body.end(), deflated.begin(), deflated.begin() + size );
+               columns[c].clear();
+            }
+            chunk_header h{ rows, column_count, body.size(), first_time, last_time };
+            if( fwrite( &h, sizeof(h), 1, out ) != 1 || fwrite( body.data(), 1, body.size(), out ) != body.size() ) {
+               throw std::runtime_error( "cannot write a chunk" );
+            }
+            total += rows;
+            chunks++;
+            rows = 0;
+         }
+
+         uint64_t rows_written() const { return total; }
+         uint64_t chunks_written() const { return chunks; }
+
+      private:
+         FILE* out;
+         uint32_t chunk_rows;
+         int level;
+         column_encoder columns[column_count];
+         std::vector<char> body;
+         std::vector<char> deflated;
+         uint32_t rows = 0;
+         uint32_t first_time = 0;
+         uint32_t last_time = 0;
+         uint64_t total = 0;
+         uint64_t chunks = 0;
+   };
+
+}
@@ -0,0 +1,207 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "columns.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+using namespace dconnect;
+
+static void usage() {
+   fprintf( stderr,
+            "usage: dconnect-export --traces FILE --out FILE [options]\n"
+            "       dconnect-export --dump FILE\n"
+            "  --contract NAME       account the token is deployed to (default dconnect)\n"
+            "  --store FILE          new store to hold the replayed state (default a temporary file)\n"
+            "  --chunk-rows N        rows per chunk (default 65536)\n"
+            "  --level N             zlib level (default 6)\n"
+            "  --lock-period S       policy at the start of the traces, as in policy.hpp\n"
+            "  --payout-rate N\n"
+            "  --vote-rate N\n"
+            "  --rate-base N\n" );
+   exit( 2 );
+}
+
+struct file_closer {
+   void operator()( FILE* f ) const { fclose( f ); }
+};
+typedef std::unique_ptr<FILE, file_closer> file_ptr;
+
+//removes a temporary store, and the copy a grow left behind, however the export ends
+struct temporary_store {
+   std::string path;
+
+   ~temporary_store() {
+      if( !path.empty() ) {
+         ::unlink( path.c_str() );
+         ::unlink( ( path + ".grow" ).c_str() );
+      }
+   }
+};
+
+static void read_exact( FILE* f, void* data, size_t size ) {
+   if( fread( data, 1, size, f ) != size ) {
+      throw std::runtime_error( "column file is truncated" );
+   }
+}
+
+//prints the rows back as csv, a chunk at a time
+static void dump( const std::string& path ) {
+   file_ptr f( fopen( path.c_str(), "rb" ) );
+   if( !f ) {
+      throw std::runtime_error( "cannot open " + path );
+   }
+   columns_header h;
+   read_exact( f.get(), &h, sizeof(h) );
+   if( memcmp( h.magic, columns_magic, sizeof(columns_magic) ) != 0 || h.version != columns_version ) {
+      throw std::runtime_error( "not a column file of this version" );
+   }
+   printf( "type,key,time,to,vote,quantity,quantity_symbol,amount,amount_symbol,content\n" );
+   chunk_header c;
+   std::vector<char> body;
+   std::vector<std::vector<char>> raw( column_count );
+   while( fread( &c, sizeof(c), 1, f.get() ) == 1 ) {
+      body.resize( c.size );
+      read_exact( f.get(), body.data(), body.size() );
+      std::vector<column_decoder> columns;
+      size_t pos = 0;
+      for( uint32_t i = 0; i < c.columns; i++ ) {
+         column_header ch;
+         if( pos + sizeof(ch) > body.size() ) {
+            throw decode_error( "chunk ends inside a column header" );
+         }
+         memcpy( &ch, body.data() + pos, sizeof(ch) );
+         pos += sizeof(ch);
+         if( ch.column != i || i >= column_count || pos + ch.size > body.size() ) {
+            throw decode_error( "bad column header" );
+         }
+         raw[i].resize( ch.raw_size );
+         uLongf size = ch.raw_size;
+         if( uncompress( reinterpret_cast<Bytef*>( raw[i].data() ), &size,
+                         reinterpret_cast<const Bytef*>( body.data() + pos ), ch.size ) != Z_OK || size != ch.raw_size ) {
+            throw decode_error( "cannot inflate a column" );
+         }
+         pos += ch.size;
+         columns.emplace_back( dconnect::encoding( ch.encoding ), raw[i].data(), raw[i].size() );
+      }
+      if( columns.size() != column_count ) {
+         throw decode_error( "chunk is missing columns" );
+      }
+      for( uint32_t r = 0; r < c.rows; r++ ) {
+         uint64_t v[column_count];
+         for( uint32_t i = 0; i < column_count; i++ ) {
+            v[i] = columns[i].next();
+         }
+         printf( "%s,%llu,%u,%s,%s,%lld,%s,%lld,%s,%llu\n", event_name( v[type_column] ),
+                 (unsigned long long)v[key_column], uint32_t( v[time_column] ),
+                 dconnect::name( v[to_column] ).to_string().c_str(), dconnect::name( v[vote_column] ).to_string().c_str(),
+                 (long long)v[quantity_column], dconnect::symbol{ v[quantity_symbol_column] }.code_string().c_str(),
+                 (long long)v[amount_column], dconnect::symbol{ v[amount_symbol_column] }.code_string().c_str(),
+                 (unsigned long long)v[content_column] );
+      }
+   }
+}
+
+int main( int argc, char** argv ) {
+   std::string trace_path, out_path, store_path, dump_path, contract = "dconnect";
+   uint32_t chunk_rows = 65536;
+   int level = 6;
+   region_header policy{};
+   policy.lock_period = 86400;
+   policy.payout_rate = 1009;
+   policy.vote_rate = 1001;
+   policy.rate_base = 1000;
+
+   for( int i = 1; i < argc; i++ ) {
+      std::string arg = argv[i];
+      if( i + 1 == argc ) {
+         usage();
+      }
+      const char* value = argv[++i];
+      if( arg == "--traces" ) trace_path = value;
+      else if( arg == "--out" ) out_path = value;
+      else if( arg == "--store" ) store_path = value;
+      else if( arg == "--dump" ) dump_path = value;
+      else if( arg == "--contract" ) contract = value;
+      else if( arg == "--chunk-rows" ) chunk_rows = strtoul( value, nullptr, 10 );
+      else if( arg == "--level" ) level = atoi( value );
+      else if( arg == "--lock-period" ) policy.lock_period = strtoul( value, nullptr, 10 );
+      else if( arg == "--payout-rate" ) policy.payout_rate = strtoll( value, nullptr, 10 );
+      else if( arg == "--vote-rate" ) policy.vote_rate = strtoll( value, nullptr, 10 );
+      else if( arg == "--rate-base" ) policy.rate_base = strtoll( value, nullptr, 10 );
+      else usage();
+   }
+
+   try {
+      if( !dump_path.empty() ) {
+         dump( dump_path );
+         return 0;
+      }
+      if( trace_path.empty() || out_path.empty() || chunk_rows == 0 ) {
+         usage();
+      }
+
+      //the state lives in a mapped store, so the exporter's memory is bounded by the live
+      //state the store holds and one chunk, not by the length of the history
+      bool temporary = store_path.empty();
+      if( temporary ) {
+         store_path = out_path + ".store";
+      }
+      struct stat st;
+      if( ::stat( store_path.c_str(), &st ) == 0 ) {
+         throw std::runtime_error( store_path + " already exists" );
+      }
+      temporary_store cleanup{ temporary ? store_path : std::string() };
+      trace_file traces( trace_path );
+      file_ptr out( fopen( out_path.c_str(), "wb" ) );
+      if( !out ) {
+         throw std::runtime_error( "cannot open " + out_path );
+      }
+      columns_header h{};
+      memcpy( h.magic, columns_magic, sizeof(columns_magic) );
+      h.version = columns_version;
+      fwrite( &h, sizeof(h), 1, out.get() );
+
+      column_writer columns( out.get(), chunk_rows, level );
+      {
+         store db( store_path, 1 << 16 );
+         db.meta() = policy;
+         state state( db, dconnect::name( contract ) );
+         state.on_event = [&]( const event& e ) { columns.add( e ); };
+
+         uint64_t offset = 0, records = 0;
+         while( auto t = traces.at( offset ) ) {
+            try {
+               state.apply( *t );
+            } catch( const std::exception& e ) {
+               fprintf( stderr, "record %llu at offset %llu (%s): %s\n", (unsigned long long)records,
+                        (unsigned long long)offset, t->action.to_string().c_str(), e.what() );
+               return 1;
+            }
+            offset = t->end;
+            records++;
+            if( db.full() ) {
+               db.commit( offset, records );
+               db.grow();
+            }
+         }
+      }
+      columns.flush();
+      if( fflush( out.get() ) != 0 ) {
+         throw std::runtime_error( "cannot write " + out_path );
+      }
+      printf( "exported %llu events in %llu chunks\n", (unsigned long long)columns.rows_written(),
+              (unsigned long long)columns.chunks_written() );
+   } catch( const std::exception& e ) {
+      fprintf( stderr, "%s\n", e.what() );
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "state.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace dconnect;
+
+static void usage() {
+   fprintf( stderr,
+            "usage: dconnect-indexer --store FILE --traces FILE [options]\n"
+            "  --contract NAME       account the token is deployed to (default dconnect)\n"
+            "  --commit-every N      records applied between commits (default 10000)\n"
+            "  --capacity N          slots in a new store (default 1048576)\n"
+            "  --lock-period S       policy of a new store, as in policy.hpp\n"
+            "  --payout-rate N\n"
+            "  --vote-rate N\n"
+            "  --rate-base N\n" );
+   exit( 2 );
+}
+
+int main( int argc, char** argv ) {
+   std::string store_path, trace_path, contract = "dconnect";
+   uint64_t commit_every = 10000, capacity = 1 << 20;
+   region_header policy{};
+   policy.lock_period = 86400;
+   policy.payout_rate = 1009;
+   policy.vote_rate = 1001;
+   policy.rate_base = 1000;
+
+   for( int i = 1; i < argc; i++ ) {
+      std::string arg = argv[i];
+      if( i + 1 == argc ) {
+         usage();
+      }
+      const char* value = argv[++i];
+      if( arg == "--store" ) store_path = value;
+      else if( arg == "--traces" ) trace_path = value;
+      else if( arg == "--contract" ) contract = value;
+      else if( arg == "--commit-every" ) commit_every = strtoull( value, nullptr, 10 );
+      else if( arg == "--capacity" ) capacity = strtoull( value, nullptr, 10 );
+      else if( arg == "--lock-period" ) policy.lock_period = strtoul( value, nullptr, 10 );
+      else if( arg == "--payout-rate" ) policy.payout_rate = strtoll( value, nullptr, 10 );
+      else if( arg == "--vote-rate" ) policy.vote_rate = strtoll( value, nullptr, 10 );
+      else if( arg == "--rate-base" ) policy.rate_base = strtoll( value, nullptr, 10 );
+      else usage();
+   }
+   if( store_path.empty() || trace_path.empty() || commit_every == 0 ) {
+      usage();
+   }
+
+   try {
+      store db( store_path, capacity );
+      if( db.records() == 0 && db.meta().rate_base == 0 ) {
+         auto& m = db.meta();
+         m.lock_period = policy.lock_period;
+         m.payout_rate = policy.payout_rate;
+         m.vote_rate = policy.vote_rate;
+         m.rate_base = policy.rate_base;
+      }
+      trace_file traces( trace_path );
+      state st( db, dconnect::name( contract ) );
+
+      //picks up where the last commit left off, so restarting doesn't replay history
+      uint64_t offset = db.offset();
+      uint64_t records = db.records();
+      uint64_t start = records;
+      uint64_t uncommitted = 0;
+      while( auto t = traces.at( offset ) ) {
+         try {
+            st.apply( *t );
+         } catch( const std::exception& e ) {
+            fprintf( stderr, "record %llu at offset %llu (%s): %s\n", (unsigned long long)records,
+                     (unsigned long long)offset, t->action.to_string().c_str(), e.what() );
+            return 1;
+         }
+         offset = t->end;
+         records++;
+         if( ++uncommitted == commit_every || db.full() ) {
+            db.commit( offset, records );
+            uncommitted = 0;
+            if( db.full() ) {
+               db.grow();
+            }
+         }
+      }
+      if( uncommitted > 0 ) {
+         db.commit( offset, records );
+      }
+
+      const auto& m = db.meta();
+      printf( "applied %llu records, %llu in total up to offset %llu\n", (unsigned long long)( records - start ),
+              (unsigned long long)records, (unsigned long long)offset );
+      printf( "rewards queued %llu, payouts queued %llu, %llu of %llu slots used\n",
+              (unsigned long long)( m.reward_tail - m.reward_head ), (unsigned long long)( m.payout_tail - m.payout_head ),
+              (unsigned long long)db.used(), (unsigned long long)db.capacity() );
+   } catch( const std::exception& e ) {
+      fprintf( stderr, "%s\n", e.what() );
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,550 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "../common/rows.hpp"
+#include "../common/trace.hpp"
+#include "store.hpp"
+
+#include <dconnect-reward/hot.hpp>
+#include <dconnect-reward/settle.hpp>
+
+#include <functional>
+
+//the token's state transitions, applied to a store instead of contract tables. Traces are
+//of actions that succeeded, so a transition that would have failed on chain means the
+//traces and the store disagree and is reported as an error
+namespace dconnect {
+
+   struct state_error : std::runtime_error {
+      using std::runtime_error::runtime_error;
+   };
+
+   struct balance_row {
+      dconnect::asset balance;
+   };
+
+   struct stat_row {
+      dconnect::asset supply;
+      dconnect::asset max_supply;
+      dconnect::name issuer;
+      dconnect::name bounty_contract;
+      dconnect::asset bounty;
+      uint32_t lastpay;
+      uint64_t bounty_rate;
+   };
+
+   //a row of the rewards or payouts queue. next links an owner's rewards in one symbol
+   struct queue_row {
+      dconnect::name to;
+      dconnect::name vote;
+      uint32_t time;
+      dconnect::asset quantity;
+      dconnect::asset bounty;
+      uint64_t content;
+      uint64_t next;
+   };
+
+   struct total_row {
+      dconnect::name name;
+      uint32_t time;
+      dconnect::asset quantity;
+      uint64_t content;
+      uint64_t hot;
+   };
+
+   //head and tail are the owner's first and last reward in the symbol, as keys plus one
+   struct pending_row {
+      dconnect::asset locked;
+      dconnect::asset expected;
+      uint64_t count;
+      uint32_t next_maturity;
+      uint64_t head;
+      uint64_t tail;
+   };
+
+   //what the contract's log actions report, for consumers that follow the indexer
+   struct event {
+      enum type_t { reward, retire, payout, settle } type;
+      uint64_t key;
+      uint32_t time;
+      dconnect::name to;
+      dconnect::name vote;
+      dconnect::asset quantity;    //locked by reward, retired, or paid out to the owner
+      dconnect::asset amount;      //bounty of a retire or payout, voter cut of a settle
+      uint64_t content;
+   };
+
+   namespace actions {
+      constexpr uint64_t create = dconnect::name( "create" ).value;
+      constexpr uint64_t setconfig = dconnect::name( "setconfig" ).value;
+      constexpr uint64_t issue = dconnect::name( "issue" ).value;
+      constexpr uint64_t transfer = dconnect::name( "transfer" ).value;
+      constexpr uint64_t open = dconnect::name( "open" ).value;
+      constexpr uint64_t close = dconnect::name( "close" ).value;
+      constexpr uint64_t reward = dconnect::name( "reward" ).value;
+      constexpr uint64_t retire = dconnect::name( "retire" ).value;
+      constexpr uint64_t pay = dconnect::name( "pay" ).value;
+      constexpr uint64_t crank = dconnect::name( "crank" ).value;
+      constexpr uint64_t importrows = dconnect::name( "importrows" ).value;
+      constexpr uint64_t backfill = dconnect::name( "backfill" ).value;
+   }
+
+   namespace tables {
+      constexpr uint64_t stat = dconnect::name( "stat" ).value;
+      constexpr uint64_t accounts = dconnect::name( "accounts" ).value;
+      constexpr uint64_t totals = dconnect::name( "totals" ).value;
+      constexpr uint64_t contents = dconnect::name( "contents" ).value;
+      constexpr uint64_t payouts = dconnect::name( "payouts" ).value;
+      constexpr uint64_t rewards = dconnect::name( "rewards" ).value;   //a scope of payouts
+   }
+
+   inline uint32_t row_size( uint64_t table ) {
+      switch( table ) {
+         case tables::stat: return currency_stats_view::packed_size;
+         case tables::accounts: return account_view::packed_size;
+         case tables::totals:
+         case tables::contents: return total_view::packed_size;
+         case tables::payouts: return payout_view::packed_size;
+      }
+      throw std::runtime_error( "unknown table " + dconnect::name( table ).to_string() );
+   }
+
+   //the token whose bounty a transfer to the contract tops up, or 0 if it isn't a top up
+   inline uint64_t bounty_code( dconnect::name contract, dconnect::name from, dconnect::name to,
+                                const dconnect::asset& quantity, std::string_view memo ) {
+      if( to != contract || from == contract ) {
+         return 0;
+      }
+      if( memo.empty() ) {
+         return quantity.symbol.code();
+      }
+      if( memo.size() > 7 ) {
+         return 0;
+      }
+      for( char c : memo ) {
+         if( c < 'A' || c > 'Z' ) {
+            return 0;
+         }
+      }
+      return dconnect::symbol::code_from_string( memo );
+   }
+
+   template<typename Store>
+   class basic_state {
+      public:
+         static constexpr uint64_t next_key = ~0ull;
+
+         basic_state( Store& db, dconnect::name contract ) : db( db ), contract( contract ) {}
+
+         std::function<void( const event& )> on_event;
+
+         //applies one action trace; actions the token doesn't handle are skipped. A reward
+         //is queued under reward_key if one is given instead of taking the next key
+         void apply( const trace& t, uint64_t reward_key = next_key ) {
+            reader r( t.data, t.size );
+            if( t.account != contract ) {
+               if( t.action.value == actions::transfer ) {
+                  ontransfer( t.account, r );
+               }
+               return;
+            }
+            now = t.time;
+            switch( t.action.value ) {
+               case actions::transfer: {
+                  auto from = r.read_name();
+                  auto to = r.read_name();
+                  transfer( from, to, r.read_asset() );
+                  break;
+               }
+               case actions::reward: {
+                  auto to = r.read_name();
+                  auto vote = r.read_name();
+                  auto quantity = r.read_asset();
+                  r.read_string();
+                  reward( to, vote, quantity, r.read<int64_t>(), reward_key );
+                  break;
+               }
+               case actions::retire: {
+                  auto to = r.read_name();
+                  retire( to, r.read_asset() );
+                  break;
+               }
+               case actions::pay:
+                  settle( 1 );
+                  break;
+               case actions::crank:
+                  if( settle( r.read<uint32_t>() ) == 0 ) {
+                     throw state_error( "nothing to settle" );
+                  }
+                  break;
+               case actions::issue:
+                  r.read_name();
+                  issue( r.read_asset() );
+                  break;
+               case actions::create: {
+                  auto issuer = r.read_name();
+                  auto max_supply = r.read_asset();
+                  auto bounty_contract = r.read_name();
+                  auto bounty = r.read_asset();
+                  create( issuer, max_supply, bounty_contract, bounty, r.read<uint64_t>() );
+                  break;
+               }
+               case actions::open: {
+                  auto owner = r.read_name();
+                  open( owner, r.read_symbol() );
+                  break;
+               }
+               case actions::close: {
+                  auto owner = r.read_name();
+                  close( owner, r.read_symbol() );
+                  break;
+               }
+               case actions::importrows: {
+                  uint64_t table = r.read_name().value;
+                  auto rows = r.read_string();
+                  size_t size = 8 + row_size( table );
+                  if( rows.size() % size != 0 ) {
+                     throw state_error( "imported rows are truncated" );
+                  }
+                  for( size_t pos = 0; pos < rows.size(); pos += size ) {
+                     uint64_t scope;
+                     memcpy( &scope, rows.data() + pos, sizeof(scope) );
+                     import_row( table, scope, rows.data() + pos + 8, size - 8 );
+                  }
+                  break;
+               }
+               case actions::backfill:
+                  //only moves the commitment, which the store doesn't keep
+                  break;
+               case actions::setconfig: {
+                  auto& m = db.meta();
+                  m.lock_period = r.read<uint32_t>();
+                  m.payout_rate = r.read<int64_t>();
+                  m.vote_rate = r.read<int64_t>();
+                  m.rate_base = r.read<int64_t>();
+                  break;
+               }
+            }
+         }
+
+         //writes a row in the contract's encoding, as importrows and a snapshot restore do. Queue
+         //rows keep their keys, so the queue's tail moves past them and settle skips the gap
+         void import_row( uint64_t table, uint64_t scope, const char* data, size_t size ) {
+            switch( table ) {
+               case tables::stat: {
+                  currency_stats_view v( data, size );
+                  auto& row = db.template upsert<stat_row>( kind::stat, v.primary_key(), 0 );
+                  row.supply = v.supply();
+                  row.max_supply = v.max_supply();
+                  row.issuer = v.issuer();
+                  row.bounty_contract = v.bounty_contract();
+                  row.bounty = v.bounty();
+                  row.lastpay = v.lastpay();
+                  row.bounty_rate = v.bounty_rate();
+                  break;
+               }
+               case tables::accounts: {
+                  account_view v( data, size );
+                  db.template upsert<balance_row>( kind::balance, scope, v.primary_key() ).balance = v.balance();
+                  break;
+               }
+               case tables::totals:
+               case tables::contents: {
+                  total_view v( data, size );
+                  auto& t = table == tables::totals ? db.template upsert<total_row>( kind::user_total, scope, v.pk() )
+                                                    : db.template upsert<total_row>( kind::content_total, v.pk(), 0 );
+                  t.name = v.name();
+                  t.time = v.time();
+                  t.quantity = v.quantity();
+                  t.content = v.content();
+                  t.hot = v.hot();
+                  break;
+               }
+               case tables::payouts: {
+                  payout_view v( data, size );
+                  auto& m = db.meta();
+                  if( scope == tables::rewards ) {
+                     queue_reward( v.pk(), v.to(), v.vote(), v.time(), v.quantity(), v.content() );
+                     m.reward_tail = std::max( m.reward_tail, v.pk() + 1 );
+                  } else {
+                     queue_payout( v.pk(), v.to(), v.time(), v.quantity(), v.bounty() );
+                     m.payout_tail = std::max( m.payout_tail, v.pk() + 1 );
+                  }
+                  break;
+               }
+            }
+         }
+
+         //adds a row to the rewards queue along with the owner's pending row, keys in increasing order
+         void queue_reward( uint64_t key, dconnect::name to, dconnect::name vote, uint32_t time,
+                            const dconnect::asset& quantity, uint64_t content ) {
+            auto& row = db.template upsert<queue_row>( kind::reward, 0, key );
+            row.to = to;
+            row.vote = vote;
+            row.time = time;
+            row.quantity = quantity;
+            row.content = content;
+
+            int64_t payout, cut, minted;
+            settle_amounts( quantity.amount, payout, cut, minted );
+            bool created;
+            auto& p = db.template upsert<pending_row>( kind::pending, to.value, quantity.symbol.code(), &created );
+            if( created ) {
+               p.locked.symbol = quantity.symbol;
+               p.expected.symbol = quantity.symbol;
+               p.next_maturity = time + db.meta().lock_period;
+               p.head = key + 1;
+            } else {
+               db.template find<queue_row>( kind::reward, 0, p.tail - 1 )->next = key + 1;
+            }
+            p.tail = key + 1;
+            p.locked.amount += quantity.amount;
+            p.expected.amount += payout;
+            p.count++;
+         }
+
+         //adds a row to the payouts queue, the owner must have no other payout in the symbol
+         void queue_payout( uint64_t key, dconnect::name to, uint32_t time,
+                            const dconnect::asset& quantity, const dconnect::asset& bounty ) {
+            auto& row = db.template upsert<queue_row>( kind::payout, 0, key );
+            row.to = to;
+            row.time = time;
+            row.quantity = quantity;
+            row.bounty = bounty;
+            db.template upsert<uint64_t>( kind::owner_payout, to.value, quantity.symbol.code() ) = key;
+         }
+
+      private:
+         void create( dconnect::name issuer, const dconnect::asset& max_supply, dconnect::name bounty_contract,
+                      const dconnect::asset& bounty, uint64_t bounty_rate ) {
+            bool created;
+            auto& st = db.template upsert<stat_row>( kind::stat, max_supply.symbol.code(), 0, &created );
+            if( !created ) {
+               throw state_error( "token with symbol already exists" );
+            }
+            st.supply.symbol = max_supply.symbol;
+            st.max_supply = max_supply;
+            st.issuer = issuer;
+            st.bounty_contract = bounty_contract;
+            st.bounty = bounty;
+            st.lastpay = now;
+            st.bounty_rate = bounty_rate;
+         }
+
+         //the issuer is credited here, the transfer on to the recipient is its own trace
+         void issue( const dconnect::asset& quantity ) {
+            auto& st = get_stat( quantity.symbol );
+            if( quantity.amount > st.max_supply.amount - st.supply.amount ) {
+               throw state_error( "quantity exceeds available supply" );
+            }
+            st.supply.amount += quantity.amount;
+            add_balance( st.issuer, quantity );
+         }
+
+         void transfer( dconnect::name from, dconnect::name to, const dconnect::asset& quantity ) {
+            get_stat( quantity.symbol );
+            sub_balance( from, quantity );
+            add_balance( to, quantity );
+         }
+
+         void open( dconnect::name owner, dconnect::symbol sym ) {
+            get_stat( sym );
+            bool created;
+            auto& b = db.template upsert<balance_row>( kind::balance, owner.value, sym.code(), &created );
+            if( created ) {
+               b.balance.symbol = sym;
+            }
+         }
+
+         void close( dconnect::name owner, dconnect::symbol sym ) {
+            auto* b = db.template find<balance_row>( kind::balance, owner.value, sym.code() );
+            if( !b || b->balance.amount != 0 ) {
+               throw state_error( "balance can't be closed" );
+            }
+            db.erase( kind::balance, owner.value, sym.code() );
+         }
+
+         void ontransfer( dconnect::name code, reader& r ) {
+            auto from = r.read_name();
+            auto to = r.read_name();
+            auto quantity = r.read_asset();
+            uint64_t sym = bounty_code( contract, from, to, quantity, r.read_string() );
+            if( sym == 0 ) {
+               return;
+            }
+            auto* st = db.template find<stat_row>( kind::stat, sym, 0 );
+            if( !st || st->bounty_contract != code ) {
+               return;
+            }
+            if( quantity.symbol != st->bounty.symbol ) {
+               throw state_error( "bounty symbol mismatch" );
+            }
+            st->bounty.amount += quantity.amount;
+         }
+
+         void reward( dconnect::name to, dconnect::name vote, const dconnect::asset& quantity, int64_t content,
+                      uint64_t key ) {
+            get_stat( quantity.symbol );
+            sub_balance( to, quantity );
+
+            if( key == next_key ) {
+               key = db.meta().reward_tail++;
+            }
+            queue_reward( key, to, vote, now, quantity, content );
+            emit( event::reward, key, to, vote, quantity, dconnect::asset{ 0, quantity.symbol }, content );
+
+            uint64_t hot = eosio::hot_score( quantity.amount, now );
+            add_total( kind::user_total, to.value, quantity.symbol.code(), to, quantity, content, hot );
+            add_total( kind::content_total, uint64_t( content ), 0, to, quantity, content, hot );
+         }
+
+         void add_total( dconnect::kind k, uint64_t k1, uint64_t k2, dconnect::name to, const dconnect::asset& quantity,
+                         int64_t content, uint64_t hot ) {
+            bool created;
+            auto& t = db.template upsert<total_row>( k, k1, k2, &created );
+            if( created ) {
+               t.name = to;
+               t.time = now;
+               t.quantity = quantity;
+               t.content = content;
+               t.hot = hot;
+            } else {
+               t.quantity.amount += quantity.amount;
+               t.hot = eosio::hot_add( t.hot, hot );
+            }
+         }
+
+         //the same single precision share of the bounty the contract works out
+         void retire( dconnect::name to, const dconnect::asset& quantity ) {
+            auto& st = get_stat( quantity.symbol );
+            float share = (float)quantity.amount / (float)st.supply.amount;
+            uint64_t amount = st.bounty.amount * share;
+            dconnect::asset bounty{ int64_t( amount ), st.bounty.symbol };
+            if( bounty.amount <= 0 || bounty.amount > st.bounty.amount ) {
+               throw state_error( "not enough bounty to claim from" );
+            }
+            sub_balance( to, quantity );
+            st.supply.amount -= quantity.amount;
+            st.bounty.amount -= bounty.amount;
+
+            uint64_t sym = quantity.symbol.code();
+            uint64_t key;
+            if( auto* owned = db.template find<uint64_t>( kind::owner_payout, to.value, sym ) ) {
+               key = *owned;
+               auto* row = db.template find<queue_row>( kind::payout, 0, key );
+               row->bounty.amount += bounty.amount;
+               row->quantity.amount += quantity.amount;
+            } else {
+               key = db.meta().payout_tail++;
+               queue_payout( key, to, now, quantity, bounty );
+            }
+            emit( event::retire, key, to, dconnect::name(), quantity, bounty, 0 );
+         }
+
+         //payouts drain first, then rewards in the order they were locked until one hasn't matured
+         uint32_t settle( uint32_t max_items ) {
+            auto& m = db.meta();
+            uint32_t done = 0;
+            for( ; next_row( kind::payout, m.payout_head, m.payout_tail ) && done < max_items; done++ ) {
+               uint64_t key = m.payout_head++;
+               queue_row row = *db.template find<queue_row>( kind::payout, 0, key );
+               emit( event::payout, key, row.to, dconnect::name(), row.quantity, row.bounty, 0 );
+               db.erase( kind::owner_payout, row.to.value, row.quantity.symbol.code() );
+               db.erase( kind::payout, 0, key );
+            }
+            for( ; next_row( kind::reward, m.reward_head, m.reward_tail ) && done < max_items; done++ ) {
+               uint64_t key = m.reward_head;
+               queue_row row = *db.template find<queue_row>( kind::reward, 0, key );
+               if( now < row.time + m.lock_period ) {
+                  break;
+               }
+               m.reward_head++;
+               int64_t payout, cut, minted;
+               settle_amounts( row.quantity.amount, payout, cut, minted );
+               dconnect::asset paid{ payout, row.quantity.symbol };
+               add_balance( row.to, paid );
+               add_balance( row.vote, dconnect::asset{ cut, row.quantity.symbol } );
+               get_stat( row.quantity.symbol ).supply.amount += minted;
+               emit( event::settle, key, row.to, row.vote, paid, dconnect::asset{ cut, row.quantity.symbol }, row.content );
+               db.erase( kind::reward, 0, key );
+
+               //the settled reward is always the first of its owner's, so it leaves the front of the list
+               auto* p = db.template find<pending_row>( kind::pending, row.to.value, row.quantity.symbol.code() );
+               if( !p ) {
+                  continue;
+               }
+               if( p->count <= 1 ) {
+                  db.erase( kind::pending, row.to.value, row.quantity.symbol.code() );
+                  continue;
+               }
+               p->locked.amount -= row.quantity.amount;
+               p->expected.amount -= payout;
+               p->count--;
+               p->head = row.next;
+               p->next_maturity = db.template find<queue_row>( kind::reward, 0, p->head - 1 )->time + m.lock_period;
+            }
+            return done;
+         }
+
+         //moves head past keys with no row, which imported rows leave below themselves
+         bool next_row( dconnect::kind k, uint64_t& head, uint64_t tail ) {
+            while( head < tail && !db.template find<queue_row>( k, 0, head ) ) {
+               head++;
+            }
+            return head < tail;
+         }
+
+         void settle_amounts( int64_t quantity, int64_t& payout, int64_t& cut, int64_t& minted ) const {
+            const auto& m = db.meta();
+            eosio::settle_batch( &quantity, &payout, &cut, &minted, 1, m.payout_rate, m.vote_rate, m.rate_base );
+         }
+
+         stat_row& get_stat( dconnect::symbol sym ) {
+            auto* st = db.template find<stat_row>( kind::stat, sym.code(), 0 );
+            if( !st ) {
+               throw state_error( "token with symbol does not exist" );
+            }
+            if( st->supply.symbol != sym ) {
+               throw state_error( "symbol precision mismatch" );
+            }
+            return *st;
+         }
+
+         void sub_balance( dconnect::name owner, const dconnect::asset& value ) {
+            auto* b = db.template find<balance_row>( kind::balance, owner.value, value.symbol.code() );
+            if( !b ) {
+               throw state_error( "no balance object found" );
+            }
+            if( b->balance.amount < value.amount ) {
+               throw state_error( "overdrawn balance" );
+            }
+            b->balance.amount -= value.amount;
+         }
+
+         void add_balance( dconnect::name owner, const dconnect::asset& value ) {
+            bool created;
+            auto& b = db.template upsert<balance_row>( kind::balance, owner.value, value.symbol.code(), &created );
+            if( created ) {
+               b.balance.symbol = value.symbol;
+            }
+            b.balance.amount += value.amount;
+         }
+
+         void emit( event::type_t type, uint64_t key, dconnect::name to, dconnect::name vote,
+                    const dconnect::asset& quantity, const dconnect::asset& amount, uint64_t content ) {
+            if( on_event ) {
+               on_event( event{ type, key, now, to, vote, quantity, amount, content } );
+            }
+         }
+
+         Store& db;
+         dconnect::name contract;
+         uint32_t now = 0;
+   };
+
+   typedef basic_state<store> state;
+
+}
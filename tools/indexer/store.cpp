@@ -0,0 +1,220 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "store.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace dconnect {
+
+static const char store_magic[8] = { 'd', 'c', 'i', 'n', 'd', 'e', 'x', 0 };
+static constexpr uint64_t header_size = 4096;
+
+store::store( const std::string& path, uint64_t capacity ) : path( path ) {
+   struct stat st;
+   map( path, capacity, ::stat( path.c_str(), &st ) != 0 );
+}
+
+store::~store() {
+   unmap();
+}
+
+void store::map( const std::string& file, uint64_t capacity, bool create ) {
+   fd = ::open( file.c_str(), O_RDWR | ( create ? O_CREAT | O_EXCL : 0 ), 0644 );
+   if( fd < 0 ) {
+      throw std::runtime_error( "cannot open store " + file );
+   }
+   if( create ) {
+      if( capacity == 0 ) {
+         throw std::runtime_error( "store capacity must be positive" );
+      }
+      length = header_size + 2 * ( sizeof(region_header) + capacity * sizeof(slot) );
+      if( ftruncate( fd, length ) != 0 ) {
+         throw std::runtime_error( "cannot size store " + file );
+      }
+   } else {
+      struct stat st;
+      fstat( fd, &st );
+      length = st.st_size;
+   }
+   base = static_cast<char*>( mmap( nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) );
+   if( base == MAP_FAILED ) {
+      base = nullptr;
+      throw std::runtime_error( "cannot map store " + file );
+   }
+
+   if( create ) {
+      //a fresh file is all zeroes, which is an empty table in both regions
+      memcpy( header()->magic, store_magic, sizeof(store_magic) );
+      header()->version = version;
+      header()->current = 0;
+      header()->capacity = capacity;
+      msync( base, length, MS_SYNC );
+   } else if( memcmp( header()->magic, store_magic, sizeof(store_magic) ) != 0 || header()->version != version ) {
+      throw std::runtime_error( file + " is not a store of this version" );
+   } else if( length != header_size + 2 * region_size() ) {
+      throw std::runtime_error( file + " has the wrong size for its capacity" );
+   }
+
+   //work on the copy that isn't committed, starting from the committed state. All of it
+   //was copied, so the first commit syncs the whole region
+   working = header()->current ^ 1;
+   memcpy( region_at( working ), region_at( header()->current ), region_size() );
+   page_size = sysconf( _SC_PAGESIZE );
+   uint64_t pages = ( region_size() + page_size - 1 ) / page_size;
+   written.clear();
+   written_mark.assign( pages, false );
+   carried.resize( pages );
+   for( uint64_t p = 0; p < pages; p++ ) {
+      carried[p] = p;
+   }
+}
+
+void store::unmap() {
+   if( base ) {
+      munmap( base, length );
+      base = nullptr;
+   }
+   if( fd >= 0 ) {
+      ::close( fd );
+      fd = -1;
+   }
+}
+
+region_header* store::region_at( uint32_t r ) const {
+   return reinterpret_cast<region_header*>( base + header_size + r * region_size() );
+}
+
+uint64_t store::hash( dconnect::kind k, uint64_t k1, uint64_t k2 ) {
+   uint64_t h = k1 * 0x9e3779b97f4a7c15ull ^ ( k2 + uint64_t( k ) * 0xbf58476d1ce4e5b9ull );
+   h ^= h >> 31;
+   h *= 0x94d049bb133111ebull;
+   h ^= h >> 29;
+   return h;
+}
+
+//linear probing, so the slot is either the match or the empty slot ending the run
+slot* store::lookup( dconnect::kind k, uint64_t k1, uint64_t k2 ) {
+   slot* slots = slots_of( working );
+   uint64_t mask = capacity() - 1;
+   bool pow2 = ( capacity() & mask ) == 0;
+   uint64_t i = pow2 ? hash( k, k1, k2 ) & mask : hash( k, k1, k2 ) % capacity();
+   for( ;; ) {
+      slot& s = slots[i];
+      if( s.kind == dconnect::kind::empty || ( s.kind == k && s.k1 == k1 && s.k2 == k2 ) ) {
+         return &s;
+      }
+      i = i + 1 == capacity() ? 0 : i + 1;
+   }
+}
+
+//backward shift deletion keeps probe runs unbroken without tombstones
+void store::erase( dconnect::kind k, uint64_t k1, uint64_t k2 ) {
+   slot* slots = slots_of( working );
+   slot* s = lookup( k, k1, k2 );
+   if( s->kind != k ) {
+      return;
+   }
+   uint64_t hole = s - slots;
+   uint64_t i = hole;
+   for( ;; ) {
+      i = i + 1 == capacity() ? 0 : i + 1;
+      slot& next = slots[i];
+      if( next.kind == dconnect::kind::empty ) {
+         break;
+      }
+      uint64_t mask = capacity() - 1;
+      uint64_t h = hash( next.kind, next.k1, next.k2 );
+      uint64_t home = ( capacity() & mask ) == 0 ? h & mask : h % capacity();
+      //next may move into the hole unless its home lies cyclically in (hole, i]
+      bool stays = hole <= i ? ( home > hole && home <= i ) : ( home > hole || home <= i );
+      if( !stays ) {
+         touch( &slots[hole], sizeof(slot) );
+         slots[hole] = next;
+         hole = i;
+      }
+   }
+   touch( &slots[hole], sizeof(slot) );
+   memset( &slots[hole], 0, sizeof(slot) );
+   meta().used--;
+}
+
+//a sorted list of region pages as runs of bytes of the region
+static std::vector<std::pair<uint64_t, uint64_t>> page_runs( const std::vector<uint64_t>& pages, uint64_t page_size, uint64_t limit ) {
+   std::vector<std::pair<uint64_t, uint64_t>> runs;
+   for( uint64_t p : pages ) {
+      uint64_t begin = p * page_size, end = std::min( begin + page_size, limit );
+      if( !runs.empty() && runs.back().second >= begin ) {
+         runs.back().second = std::max( runs.back().second, end );
+      } else {
+         runs.emplace_back( begin, end );
+      }
+   }
+   return runs;
+}
+
+void store::commit( uint64_t offset, uint64_t records ) {
+   std::sort( written.begin(), written.end() );
+   std::vector<uint64_t> unsynced;
+   std::merge( written.begin(), written.end(), carried.begin(), carried.end(), std::back_inserter( unsynced ) );
+   char* from = reinterpret_cast<char*>( region_at( working ) );
+   for( auto run : page_runs( unsynced, page_size, region_size() ) ) {
+      //the regions don't start on a page boundary, and msync wants one
+      char* start = from + run.first;
+      char* aligned = base + ( start - base ) / page_size * page_size;
+      msync( aligned, from + run.second - aligned, MS_SYNC );
+   }
+   header()->current = working;
+   header()->offset = offset;
+   header()->records = records;
+   msync( base, header_size, MS_SYNC );
+
+   //the other region is one commit behind, and differs from this one in the pages just written
+   working ^= 1;
+   char* to = reinterpret_cast<char*>( region_at( working ) );
+   for( auto run : page_runs( written, page_size, region_size() ) ) {
+      memcpy( to + run.first, from + run.first, run.second - run.first );
+   }
+   for( uint64_t p : written ) {
+      written_mark[p] = false;
+   }
+   carried.swap( written );
+   written.clear();
+}
+
+void store::grow() {
+   std::string tmp = path + ".grow";
+   ::unlink( tmp.c_str() );
+   uint64_t offset = header()->offset;
+   uint64_t records = header()->records;
+   {
+      store bigger( tmp, capacity() * 2 );
+      *bigger.region() = *region_at( header()->current );
+      bigger.region()->used = 0;
+      const slot* slots = slots_of( header()->current );
+      for( uint64_t i = 0; i < capacity(); i++ ) {
+         if( slots[i].kind != dconnect::kind::empty ) {
+            slot* s = bigger.lookup( slots[i].kind, slots[i].k1, slots[i].k2 );
+            *s = slots[i];
+            bigger.region()->used++;
+         }
+      }
+      bigger.commit( offset, records );
+   }
+   if( ::rename( tmp.c_str(), path.c_str() ) != 0 ) {
+      throw std::runtime_error( "cannot replace " + path );
+   }
+   unmap();
+   map( path, 0, false );
+}
+
+}
@@ -0,0 +1,174 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//a hash table of fixed-size slots in a memory-mapped file. The file holds two copies
+//of the table; the header names the committed one, and changes go to the other until
+//commit() flips the header, so a crash at any point leaves the last commit intact.
+//Slots and the region header handed out for writing mark their pages dirty, and a commit
+//syncs and copies only those, so its cost follows what changed rather than the capacity
+namespace dconnect {
+
+   enum class kind : uint32_t {
+      empty = 0,
+      balance,          //(owner, symbol code)
+      stat,             //(symbol code, 0)
+      reward,           //(0, key)
+      payout,           //(0, key)
+      user_total,       //(user, symbol code)
+      content_total,    //(content, 0)
+      pending,          //(owner, symbol code)
+      owner_payout      //(owner, symbol code), key of the owner's undrained payout
+   };
+
+   struct slot {
+      dconnect::kind kind;
+      uint32_t reserved;
+      uint64_t k1;
+      uint64_t k2;
+      char payload[88];
+   };
+
+   //queue keys are handed out in sequence, so each queue is the key range [head, tail).
+   //the policy lives here too since setconfig can change it part way through the traces
+   struct region_header {
+      uint64_t used;
+      uint64_t reward_head;
+      uint64_t reward_tail;
+      uint64_t payout_head;
+      uint64_t payout_tail;
+      uint32_t lock_period;
+      uint32_t reserved;
+      int64_t payout_rate;
+      int64_t vote_rate;
+      int64_t rate_base;
+   };
+
+   struct store_header {
+      char magic[8];
+      uint32_t version;
+      uint32_t current;
+      uint64_t capacity;
+      uint64_t offset;      //trace file offset the committed state covers
+      uint64_t records;     //trace records applied to the committed state
+   };
+
+   class store {
+      public:
+         static constexpr uint32_t version = 1;
+
+         //opens the store at path, creating it with room for capacity slots if it doesn't exist
+         store( const std::string& path, uint64_t capacity );
+         ~store();
+
+         store( const store& ) = delete;
+         store& operator=( const store& ) = delete;
+
+         template<typename T>
+         T* find( dconnect::kind k, uint64_t k1, uint64_t k2 ) {
+            static_assert( sizeof(T) <= sizeof(slot::payload), "payload too large for a slot" );
+            slot* s = lookup( k, k1, k2 );
+            if( s->kind != k ) {
+               return nullptr;
+            }
+            touch( s, sizeof(slot) );
+            return reinterpret_cast<T*>( s->payload );
+         }
+
+         //the existing payload, or a zeroed one that is now part of the table
+         template<typename T>
+         T& upsert( dconnect::kind k, uint64_t k1, uint64_t k2, bool* created = nullptr ) {
+            static_assert( sizeof(T) <= sizeof(slot::payload), "payload too large for a slot" );
+            slot* s = lookup( k, k1, k2 );
+            touch( s, sizeof(slot) );
+            bool fresh = s->kind != k;
+            if( fresh ) {
+               touch( region(), sizeof(region_header) );
+               s->kind = k;
+               s->k1 = k1;
+               s->k2 = k2;
+               memset( s->payload, 0, sizeof(s->payload) );
+               region()->used++;
+            }
+            if( created ) {
+               *created = fresh;
+            }
+            return *reinterpret_cast<T*>( s->payload );
+         }
+
+         void erase( dconnect::kind k, uint64_t k1, uint64_t k2 );
+
+         template<typename F>
+         void for_each( F&& f ) const {
+            const slot* slots = slots_of( working );
+            for( uint64_t i = 0; i < capacity(); i++ ) {
+               if( slots[i].kind != dconnect::kind::empty ) {
+                  f( slots[i] );
+               }
+            }
+         }
+
+         region_header& meta() {
+            touch( region(), sizeof(region_header) );
+            return *region();
+         }
+         uint64_t capacity() const { return header()->capacity; }
+         uint64_t used() const { return region()->used; }
+         uint64_t offset() const { return header()->offset; }
+         uint64_t records() const { return header()->records; }
+
+         //the table is kept under three quarters full so probe runs stay short
+         bool full() const { return used() * 4 >= capacity() * 3; }
+
+         //makes the working copy the committed one, covering the trace file up to offset
+         void commit( uint64_t offset, uint64_t records );
+
+         //rehashes the committed state into a file twice the size; call right after commit()
+         void grow();
+
+         static uint64_t hash( dconnect::kind k, uint64_t k1, uint64_t k2 );
+
+      private:
+         void map( const std::string& path, uint64_t capacity, bool create );
+         void unmap();
+         slot* lookup( dconnect::kind k, uint64_t k1, uint64_t k2 );
+
+         //marks the working region's pages under [p, p + size) as written
+         void touch( const void* p, size_t size ) {
+            uint64_t offset = static_cast<const char*>( p ) - reinterpret_cast<const char*>( region() );
+            for( uint64_t page = offset / page_size; page <= ( offset + size - 1 ) / page_size; page++ ) {
+               if( !written_mark[page] ) {
+                  written_mark[page] = true;
+                  written.push_back( page );
+               }
+            }
+         }
+
+         store_header* header() const { return reinterpret_cast<store_header*>( base ); }
+         region_header* region_at( uint32_t r ) const;
+         region_header* region() const { return region_at( working ); }
+         slot* slots_of( uint32_t r ) const { return reinterpret_cast<slot*>( region_at( r ) + 1 ); }
+         uint64_t region_size() const { return sizeof(region_header) + capacity() * sizeof(slot); }
+
+         std::string path;
+         int fd = -1;
+         char* base = nullptr;
+         uint64_t length = 0;
+         uint32_t working = 0;
+
+         //pages of the working region, counted from its start, that differ from the file: those
+         //written since the last commit, and those the last commit copied in from the other region
+         uint64_t page_size = 4096;
+         std::vector<uint64_t> written;
+         std::vector<bool> written_mark;
+         std::vector<uint64_t> carried;
+   };
+
+}
@@ -0,0 +1,187 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "loop.hpp"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+//plain http/1.1 posts of json bodies, one connection per request. Nodes are reached over http,
+//so https endpoints need a local proxy in front of them
+namespace dconnect {
+
+   struct http_error : std::runtime_error {
+      using std::runtime_error::runtime_error;
+   };
+
+   struct endpoint {
+      std::string host;
+      std::string port;
+      std::string path;
+      sockaddr_storage addr;
+      socklen_t addr_size = 0;
+   };
+
+   struct http_response {
+      int status = 0;
+      std::string body;
+   };
+
+   //resolves http://host[:port][/path] once, when the keeper starts
+   inline endpoint resolve( const std::string& url ) {
+      const std::string scheme = "http://";
+      if( url.compare( 0, scheme.size(), scheme ) != 0 ) {
+         throw http_error( "only http:// urls are supported: " + url );
+      }
+      endpoint e;
+      auto rest = url.substr( scheme.size() );
+      auto slash = rest.find( '/' );
+      e.path = slash == std::string::npos ? "" : rest.substr( slash );
+      rest = rest.substr( 0, slash );
+      auto colon = rest.rfind( ':' );
+      e.host = rest.substr( 0, colon );
+      e.port = colon == std::string::npos ? "80" : rest.substr( colon + 1 );
+      while( !e.path.empty() && e.path.back() == '/' ) {
+         e.path.pop_back();
+      }
+
+      addrinfo hints{}, *result;
+      hints.ai_family = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      if( getaddrinfo( e.host.c_str(), e.port.c_str(), &hints, &result ) != 0 ) {
+         throw http_error( "cannot resolve " + e.host );
+      }
+      memcpy( &e.addr, result->ai_addr, result->ai_addrlen );
+      e.addr_size = result->ai_addrlen;
+      freeaddrinfo( result );
+      return e;
+   }
+
+   namespace detail {
+      class socket_fd {
+         public:
+            explicit socket_fd( int fd ) : fd( fd ) {}
+            ~socket_fd() {
+               if( fd >= 0 ) {
+                  ::close( fd );
+               }
+            }
+            socket_fd( const socket_fd& ) = delete;
+            socket_fd& operator=( const socket_fd& ) = delete;
+            int get() const { return fd; }
+
+         private:
+            int fd;
+      };
+
+      inline std::string dechunk( const std::string& body ) {
+         std::string out;
+         size_t pos = 0;
+         while( true ) {
+            auto eol = body.find( "\r\n", pos );
+            if( eol == std::string::npos ) {
+               throw http_error( "truncated chunked body" );
+            }
+            size_t size = strtoull( body.c_str() + pos, nullptr, 16 );
+            pos = eol + 2;
+            if( size == 0 ) {
+               return out;
+            }
+            if( pos + size > body.size() ) {
+               throw http_error( "truncated chunked body" );
+            }
+            out.append( body, pos, size );
+            pos += size + 2;
+         }
+      }
+
+      inline http_response parse_response( const std::string& raw ) {
+         auto end = raw.find( "\r\n\r\n" );
+         if( raw.compare( 0, 5, "HTTP/" ) != 0 || end == std::string::npos ) {
+            throw http_error( "malformed http response" );
+         }
+         http_response r;
+         r.status = atoi( raw.c_str() + raw.find( ' ' ) + 1 );
+         std::string headers = raw.substr( 0, end );
+         for( auto& c : headers ) {
+            c = tolower( c );
+         }
+         r.body = raw.substr( end + 4 );
+         auto length = headers.find( "\r\ncontent-length:" );
+         if( headers.find( "\r\ntransfer-encoding: chunked" ) != std::string::npos ) {
+            r.body = dechunk( r.body );
+         } else if( length != std::string::npos ) {
+            size_t size = strtoull( headers.c_str() + length + 17, nullptr, 10 );
+            if( r.body.size() < size ) {
+               throw http_error( "truncated http response" );
+            }
+            r.body.resize( size );
+         }
+         return r;
+      }
+   }
+
+   //posts body to the endpoint's path followed by path, and reads the response to the end of the connection
+   inline task<http_response> http_post( event_loop& loop, const endpoint& e, std::string path, std::string body,
+                                         std::chrono::milliseconds timeout ) {
+      auto deadline = event_loop::clock::now() + timeout;
+      detail::socket_fd s( socket( e.addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 ) );
+      if( s.get() < 0 ) {
+         throw http_error( "cannot create a socket" );
+      }
+      if( connect( s.get(), reinterpret_cast<const sockaddr*>( &e.addr ), e.addr_size ) != 0 ) {
+         if( errno != EINPROGRESS ) {
+            throw http_error( "cannot connect to " + e.host + ":" + e.port );
+         }
+         if( !co_await loop.writable( s.get(), deadline ) ) {
+            throw http_error( "timed out connecting to " + e.host + ":" + e.port );
+         }
+         int error = 0;
+         socklen_t size = sizeof(error);
+         getsockopt( s.get(), SOL_SOCKET, SO_ERROR, &error, &size );
+         if( error != 0 ) {
+            throw http_error( "cannot connect to " + e.host + ":" + e.port + ": " + strerror( error ) );
+         }
+      }
+
+      std::string request = "POST " + e.path + path + " HTTP/1.1\r\nHost: " + e.host + "\r\n"
+                            "Content-Type: application/json\r\nContent-Length: " + std::to_string( body.size() ) +
+                            "\r\nConnection: close\r\n\r\n" + body;
+      size_t sent = 0;
+      while( sent < request.size() ) {
+         ssize_t n = send( s.get(), request.data() + sent, request.size() - sent, MSG_NOSIGNAL );
+         if( n > 0 ) {
+            sent += n;
+         } else if( n < 0 && errno != EAGAIN && errno != EINTR ) {
+            throw http_error( "cannot send to " + e.host );
+         } else if( !co_await loop.writable( s.get(), deadline ) ) {
+            throw http_error( "timed out sending to " + e.host );
+         }
+      }
+
+      std::string raw;
+      char buffer[16384];
+      while( true ) {
+         ssize_t n = recv( s.get(), buffer, sizeof(buffer), 0 );
+         if( n > 0 ) {
+            raw.append( buffer, n );
+         } else if( n == 0 ) {
+            break;
+         } else if( errno != EAGAIN && errno != EINTR ) {
+            throw http_error( "cannot read from " + e.host );
+         } else if( !co_await loop.readable( s.get(), deadline ) ) {
+            throw http_error( "timed out waiting for " + e.host );
+         }
+      }
+      co_return detail::parse_response( raw );
+   }
+
+}
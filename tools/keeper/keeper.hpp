@@ -0,0 +1,171 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "http.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string_view>
+
+//polls the metrics row and keeps cranks in flight while it shows work, on one event loop
+namespace dconnect {
+
+   using std::chrono::milliseconds;
+
+   //what the keeper needs from the metrics singleton, summed over every symbol
+   struct queue_summary {
+      uint64_t rewards = 0;
+      uint64_t payouts = 0;
+      uint32_t reward_due = 0;
+      uint32_t payout_due = 0;
+
+      //anything a crank at time now would settle
+      bool due( uint32_t now ) const {
+         return ( payouts > 0 && payout_due <= now ) || ( rewards > 0 && reward_due <= now );
+      }
+   };
+
+   //the numbers in get_table_rows json, which quotes 64 bit values that do not fit in 32 bits
+   inline void sum_field( std::string_view json, std::string_view field, uint64_t& sum, bool add ) {
+      std::string key( 1, '"' );
+      key.append( field ).append( "\":" );
+      for( size_t pos = json.find( key ); pos != std::string_view::npos; pos = json.find( key, pos ) ) {
+         pos += key.size();
+         while( pos < json.size() && ( json[pos] == ' ' || json[pos] == '"' ) ) {
+            pos++;
+         }
+         uint64_t v = strtoull( json.data() + pos, nullptr, 10 );
+         sum = add ? sum + v : v;
+         if( !add ) {
+            return;
+         }
+      }
+   }
+
+   inline queue_summary parse_metrics( std::string_view json ) {
+      if( json.find( "\"rows\":" ) == std::string_view::npos ) {
+         throw http_error( "unexpected get_table_rows response" );
+      }
+      queue_summary s;
+      uint64_t reward_due = 0, payout_due = 0;
+      sum_field( json, "reward_count", s.rewards, true );
+      sum_field( json, "payout_count", s.payouts, true );
+      sum_field( json, "reward_due", reward_due, false );
+      sum_field( json, "payout_due", payout_due, false );
+      s.reward_due = reward_due;
+      s.payout_due = payout_due;
+      return s;
+   }
+
+   //the wait before the next poll when nothing is due: twice the last one up to idle, but no
+   //later than the next queued reward matures or the next queued payout comes due
+   inline milliseconds idle_wait( milliseconds wait, milliseconds idle, const queue_summary& s, uint32_t now ) {
+      wait = std::min( wait * 2, idle );
+      if( s.rewards > 0 && s.reward_due > now ) {
+         wait = std::min( wait, milliseconds( uint64_t( s.reward_due - now ) * 1000 ) );
+      }
+      if( s.payouts > 0 && s.payout_due > now ) {
+         wait = std::min( wait, milliseconds( uint64_t( s.payout_due - now ) * 1000 ) );
+      }
+      return wait;
+   }
+
+   struct keeper {
+      event_loop& loop;
+      endpoint node;
+      endpoint push;
+      std::string contract, actor, permission;
+      unsigned in_flight = 4;
+      uint32_t max_items = 50;
+      milliseconds poll{ 1000 };
+      milliseconds idle{ 60000 };
+      milliseconds timeout{ 5000 };
+
+      //set while the last poll found work, and reset when a crank finds nothing left
+      async_event work;
+      uint64_t submitted = 0, drained = 0, failed = 0;
+
+      explicit keeper( event_loop& loop ) : loop( loop ), work( loop ) {}
+
+      std::string metrics_request() const {
+         return "{\"code\":\"" + contract + "\",\"scope\":\"" + contract + "\",\"table\":\"metrics\",\"json\":true,\"limit\":1}";
+      }
+
+      std::string crank_action() const {
+         return "{\"account\":\"" + contract + "\",\"name\":\"crank\",\"authorization\":[{\"actor\":\"" + actor +
+                "\",\"permission\":\"" + permission + "\"}],\"data\":{\"max_items\":" + std::to_string( max_items ) + "}}";
+      }
+
+      //polls often while there is work, and backs off as idle_wait says while there is none
+      task<> poller() {
+         milliseconds wait = poll;
+         bool had_work = false;
+         while( true ) {
+            try {
+               auto r = co_await http_post( loop, node, "/v1/chain/get_table_rows", metrics_request(), timeout );
+               if( r.status != 200 ) {
+                  throw http_error( "get_table_rows returned " + std::to_string( r.status ) );
+               }
+               auto s = parse_metrics( r.body );
+               uint32_t now = time( nullptr );
+               if( s.due( now ) ) {
+                  if( !had_work ) {
+                     printf( "work due: %llu rewards, %llu payouts queued\n", (unsigned long long)s.rewards,
+                             (unsigned long long)s.payouts );
+                     fflush( stdout );
+                  }
+                  had_work = true;
+                  wait = poll;
+                  work.set();
+               } else {
+                  had_work = false;
+                  work.reset();
+                  wait = idle_wait( wait, idle, s, now );
+               }
+            } catch( const std::exception& e ) {
+               fprintf( stderr, "poll: %s\n", e.what() );
+               wait = std::min( wait * 2, idle );
+            }
+            co_await loop.sleep_for( wait );
+         }
+      }
+
+      //one of in_flight submitters, each with a crank outstanding whenever there is work
+      task<> submitter() {
+         while( true ) {
+            co_await work.wait();
+            try {
+               auto r = co_await http_post( loop, push, "", crank_action(), timeout );
+               if( r.status >= 200 && r.status < 300 ) {
+                  submitted++;
+                  continue;
+               }
+               //the contract rejects a crank with nothing to settle, which means another one emptied the queues
+               if( r.body.find( "nothing to settle" ) != std::string::npos ) {
+                  drained++;
+                  work.reset();
+                  continue;
+               }
+               throw http_error( "push returned " + std::to_string( r.status ) + ": " + r.body.substr( 0, 200 ) );
+            } catch( const std::exception& e ) {
+               fprintf( stderr, "crank: %s\n", e.what() );
+               failed++;
+            }
+            co_await loop.sleep_for( poll );
+         }
+      }
+
+      void start() {
+         spawn( poller() );
+         for( unsigned i = 0; i < in_flight; i++ ) {
+            spawn( submitter() );
+         }
+      }
+   };
+
+}
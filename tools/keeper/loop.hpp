@@ -0,0 +1,179 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "task.hpp"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+//a single threaded epoll loop that coroutines wait on for a socket, a timer or an event
+namespace dconnect {
+
+   class event_loop {
+      public:
+         typedef std::chrono::steady_clock clock;
+
+         event_loop() : epfd( epoll_create1( EPOLL_CLOEXEC ) ) {
+            if( epfd < 0 ) {
+               throw std::runtime_error( "cannot create epoll instance" );
+            }
+         }
+
+         ~event_loop() { ::close( epfd ); }
+
+         event_loop( const event_loop& ) = delete;
+         event_loop& operator=( const event_loop& ) = delete;
+
+      private:
+         struct waiter;
+         typedef std::multimap<clock::time_point, waiter*> timer_map;
+
+         //one coroutine waiting for an fd, a deadline or both, resumed by whichever comes first
+         struct waiter {
+            event_loop* loop;
+            std::coroutine_handle<> h;
+            int fd = -1;
+            timer_map::iterator timer;
+            bool timed = false;
+            bool timed_out = false;
+         };
+
+      public:
+         class wait_awaiter {
+            public:
+               wait_awaiter( event_loop& loop, int fd, uint32_t events, clock::time_point deadline, bool timed )
+                  : events( events ), deadline( deadline ) {
+                  w.loop = &loop;
+                  w.fd = fd;
+                  w.timed = timed;
+               }
+
+               bool await_ready() const noexcept { return false; }
+
+               void await_suspend( std::coroutine_handle<> h ) {
+                  w.h = h;
+                  if( w.fd >= 0 ) {
+                     epoll_event ev{};
+                     ev.events = events | EPOLLONESHOT;
+                     ev.data.ptr = &w;
+                     if( epoll_ctl( w.loop->epfd, EPOLL_CTL_ADD, w.fd, &ev ) != 0 ) {
+                        throw std::runtime_error( "cannot wait on a socket" );
+                     }
+                  }
+                  if( w.timed ) {
+                     w.timer = w.loop->timers.emplace( deadline, &w );
+                  }
+               }
+
+               //false if the deadline passed first
+               bool await_resume() const noexcept { return !w.timed_out; }
+
+            private:
+               waiter w;
+               uint32_t events;
+               clock::time_point deadline;
+         };
+
+         wait_awaiter readable( int fd, clock::time_point deadline ) { return wait_awaiter( *this, fd, EPOLLIN, deadline, true ); }
+         wait_awaiter writable( int fd, clock::time_point deadline ) { return wait_awaiter( *this, fd, EPOLLOUT, deadline, true ); }
+         wait_awaiter sleep_until( clock::time_point t ) { return wait_awaiter( *this, -1, 0, t, true ); }
+         wait_awaiter sleep_for( std::chrono::milliseconds d ) { return sleep_until( clock::now() + d ); }
+
+         //resumes h on the next turn of the loop
+         void post( std::coroutine_handle<> h ) { ready.push_back( h ); }
+
+         //runs until stop is called, or while there is anything left to wait for
+         void run() {
+            std::vector<epoll_event> events( 64 );
+            while( !stopped && ( !ready.empty() || !timers.empty() || waiting > 0 ) ) {
+               while( !ready.empty() ) {
+                  auto h = ready.front();
+                  ready.pop_front();
+                  h.resume();
+               }
+               int timeout = -1;
+               if( !timers.empty() ) {
+                  auto left = std::chrono::duration_cast<std::chrono::milliseconds>( timers.begin()->first - clock::now() );
+                  timeout = left.count() < 0 ? 0 : int( left.count() ) + 1;
+               }
+               int n = epoll_wait( epfd, events.data(), events.size(), timeout );
+               for( int i = 0; i < n; i++ ) {
+                  auto* w = static_cast<waiter*>( events[i].data.ptr );
+                  epoll_ctl( epfd, EPOLL_CTL_DEL, w->fd, nullptr );
+                  if( w->timed ) {
+                     timers.erase( w->timer );
+                  }
+                  ready.push_back( w->h );
+               }
+               auto now = clock::now();
+               while( !timers.empty() && timers.begin()->first <= now ) {
+                  auto* w = timers.begin()->second;
+                  timers.erase( timers.begin() );
+                  if( w->fd >= 0 ) {
+                     epoll_ctl( epfd, EPOLL_CTL_DEL, w->fd, nullptr );
+                  }
+                  w->timed_out = true;
+                  ready.push_back( w->h );
+               }
+            }
+         }
+
+         void stop() { stopped = true; }
+
+      private:
+         friend class async_event;
+
+         int epfd;
+         //coroutines parked on an async_event are not in the timer map, so the loop counts them
+         //to know it still has work
+         size_t waiting = 0;
+         bool stopped = false;
+         timer_map timers;
+         std::deque<std::coroutine_handle<>> ready;
+   };
+
+   //a manual reset event; while it is set, waiting on it returns at once
+   class async_event {
+      public:
+         explicit async_event( event_loop& loop ) : loop( loop ) {}
+
+         void set() {
+            is_set = true;
+            for( auto h : waiters ) {
+               loop.post( h );
+            }
+            loop.waiting -= waiters.size();
+            waiters.clear();
+         }
+
+         void reset() { is_set = false; }
+         bool ready() const { return is_set; }
+
+         struct awaiter {
+            async_event& e;
+            bool await_ready() const noexcept { return e.is_set; }
+            void await_suspend( std::coroutine_handle<> h ) {
+               e.waiters.push_back( h );
+               e.loop.waiting++;
+            }
+            void await_resume() const noexcept {}
+         };
+
+         awaiter wait() { return awaiter{ *this }; }
+
+      private:
+         event_loop& loop;
+         bool is_set = false;
+         std::vector<std::coroutine_handle<>> waiters;
+   };
+
+}
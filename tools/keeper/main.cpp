@@ -0,0 +1,88 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "keeper.hpp"
+#include "../common/serialize.hpp"
+
+#include <signal.h>
+
+using namespace dconnect;
+
+static void usage() {
+   fprintf( stderr,
+            "usage: dconnect-keeper --node URL --push URL --actor NAME [options]\n"
+            "  --node URL            node whose /v1/chain/get_table_rows is polled for the metrics row\n"
+            "  --push URL            endpoint that signs and broadcasts the crank action posted to it as json\n"
+            "  --contract NAME       account the token is deployed to (default dconnect)\n"
+            "  --actor NAME          account that authorizes the cranks\n"
+            "  --permission NAME     its permission (default active)\n"
+            "  --in-flight N         crank submissions kept outstanding while there is work (default 4)\n"
+            "  --max-items N         max_items of each crank (default 50)\n"
+            "  --poll-ms N           metrics poll interval while there is work (default 1000)\n"
+            "  --idle-ms N           longest wait between polls when the queues are empty (default 60000)\n"
+            "  --timeout-ms N        per request (default 5000)\n" );
+   exit( 2 );
+}
+
+static volatile sig_atomic_t stopping = 0;
+
+static void on_signal( int ) {
+   stopping = 1;
+}
+
+static task<> watch_signals( event_loop& loop ) {
+   while( !stopping ) {
+      co_await loop.sleep_for( milliseconds( 100 ) );
+   }
+   loop.stop();
+}
+
+int main( int argc, char** argv ) {
+   event_loop loop;
+   keeper k( loop );
+   std::string node_url, push_url;
+   k.contract = "dconnect";
+   k.permission = "active";
+
+   for( int i = 1; i < argc; i++ ) {
+      std::string arg = argv[i];
+      if( i + 1 == argc ) {
+         usage();
+      }
+      const char* value = argv[++i];
+      if( arg == "--node" ) node_url = value;
+      else if( arg == "--push" ) push_url = value;
+      else if( arg == "--contract" ) k.contract = dconnect::name( value ).to_string();
+      else if( arg == "--actor" ) k.actor = dconnect::name( value ).to_string();
+      else if( arg == "--permission" ) k.permission = dconnect::name( value ).to_string();
+      else if( arg == "--in-flight" ) k.in_flight = strtoul( value, nullptr, 10 );
+      else if( arg == "--max-items" ) k.max_items = strtoul( value, nullptr, 10 );
+      else if( arg == "--poll-ms" ) k.poll = milliseconds( strtoul( value, nullptr, 10 ) );
+      else if( arg == "--idle-ms" ) k.idle = milliseconds( strtoul( value, nullptr, 10 ) );
+      else if( arg == "--timeout-ms" ) k.timeout = milliseconds( strtoul( value, nullptr, 10 ) );
+      else usage();
+   }
+   if( node_url.empty() || push_url.empty() || k.actor.empty() || k.in_flight == 0 || k.max_items == 0 ||
+       k.poll.count() == 0 || k.idle < k.poll ) {
+      usage();
+   }
+
+   try {
+      k.node = resolve( node_url );
+      k.push = resolve( push_url );
+   } catch( const std::exception& e ) {
+      fprintf( stderr, "%s\n", e.what() );
+      return 1;
+   }
+   signal( SIGINT, on_signal );
+   signal( SIGTERM, on_signal );
+
+   k.start();
+   spawn( watch_signals( loop ) );
+   loop.run();
+   printf( "%llu cranks accepted, %llu found nothing to settle, %llu failed\n", (unsigned long long)k.submitted,
+           (unsigned long long)k.drained, (unsigned long long)k.failed );
+   return 0;
+}
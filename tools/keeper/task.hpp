@@ -0,0 +1,106 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+//a lazy coroutine that starts when it is awaited and resumes its awaiter when it returns
+namespace dconnect {
+
+   namespace detail {
+      struct promise_base {
+         std::coroutine_handle<> continuation;
+         std::exception_ptr error;
+
+         struct final_awaiter {
+            bool await_ready() noexcept { return false; }
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend( std::coroutine_handle<Promise> h ) noexcept {
+               auto c = h.promise().continuation;
+               return c ? c : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+         };
+
+         std::suspend_always initial_suspend() noexcept { return {}; }
+         final_awaiter final_suspend() noexcept { return {}; }
+         void unhandled_exception() { error = std::current_exception(); }
+      };
+
+      template<typename T>
+      struct promise : promise_base {
+         std::optional<T> value;
+         void return_value( T v ) { value = std::move( v ); }
+         T result() {
+            if( error ) {
+               std::rethrow_exception( error );
+            }
+            return std::move( *value );
+         }
+      };
+
+      template<>
+      struct promise<void> : promise_base {
+         void return_void() {}
+         void result() {
+            if( error ) {
+               std::rethrow_exception( error );
+            }
+         }
+      };
+   }
+
+   template<typename T = void>
+   class task {
+      public:
+         struct promise_type : detail::promise<T> {
+            task get_return_object() { return task( std::coroutine_handle<promise_type>::from_promise( *this ) ); }
+         };
+
+         task( task&& other ) noexcept : h( std::exchange( other.h, nullptr ) ) {}
+         task( const task& ) = delete;
+         task& operator=( const task& ) = delete;
+
+         ~task() {
+            if( h ) {
+               h.destroy();
+            }
+         }
+
+         bool await_ready() const noexcept { return false; }
+
+         std::coroutine_handle<> await_suspend( std::coroutine_handle<> awaiter ) noexcept {
+            h.promise().continuation = awaiter;
+            return h;
+         }
+
+         T await_resume() { return h.promise().result(); }
+
+      private:
+         explicit task( std::coroutine_handle<promise_type> h ) : h( h ) {}
+
+         std::coroutine_handle<promise_type> h;
+   };
+
+   //runs a task to completion on its own, for the keeper's long lived loops. The frame frees
+   //itself when the task returns, and an exception it lets out ends the process
+   struct detached {
+      struct promise_type {
+         detached get_return_object() { return {}; }
+         std::suspend_never initial_suspend() noexcept { return {}; }
+         std::suspend_never final_suspend() noexcept { return {}; }
+         void return_void() {}
+         void unhandled_exception() { std::terminate(); }
+      };
+   };
+
+   inline detached spawn( task<> t ) {
+      co_await t;
+   }
+
+}
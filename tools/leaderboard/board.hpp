@@ -0,0 +1,75 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "top_k.hpp"
+#include "../indexer/state.hpp"
+
+#include <cstring>
+
+//content and user totals folded from reward events, the same sums and hot scores the contract
+//keeps in its contents and totals tables, with a top k kept current for each ranking
+namespace dconnect {
+
+   class leaderboard {
+      public:
+         enum board { content, trending, users, board_count };
+
+         //only rewards in symbol code count, or every symbol if it is 0
+         leaderboard( size_t k, uint64_t code ) : code( code ), boards{ top_k( k ), top_k( k ), top_k( k ) } {}
+
+         void add( const event& e ) {
+            if( e.type != event::reward || ( code != 0 && e.quantity.symbol.code() != code ) ) {
+               return;
+            }
+            uint64_t hot = eosio::hot_score( e.quantity.amount, e.time );
+            auto& c = contents[e.content];
+            add_total( c, e.quantity.amount, hot );
+            boards[content].update( e.content, c.amount );
+            boards[trending].update( e.content, c.hot );
+
+            auto& u = totals[e.to.value];
+            add_total( u, e.quantity.amount, hot );
+            boards[users].update( e.to.value, u.amount );
+            rewards++;
+         }
+
+         std::vector<top_k::item> top( board b, size_t n ) const { return boards[b].top( n ); }
+
+         static bool parse_board( const char* str, board& b ) {
+            static const char* names[] = { "content", "trending", "users" };
+            for( int i = 0; i < board_count; i++ ) {
+               if( strcmp( str, names[i] ) == 0 ) {
+                  b = board( i );
+                  return true;
+               }
+            }
+            return false;
+         }
+
+         uint64_t rewards_seen() const { return rewards; }
+         size_t content_count() const { return contents.size(); }
+         size_t user_count() const { return totals.size(); }
+
+      private:
+         struct total {
+            uint64_t amount;
+            uint64_t hot;
+            uint64_t count;
+         };
+
+         static void add_total( total& t, int64_t amount, uint64_t hot ) {
+            t.amount += amount;
+            t.hot = t.count++ == 0 ? hot : eosio::hot_add( t.hot, hot );
+         }
+
+         uint64_t code;
+         flat_map<total> contents;
+         flat_map<total> totals;
+         top_k boards[board_count];
+         uint64_t rewards = 0;
+   };
+
+}
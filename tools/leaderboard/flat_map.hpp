@@ -0,0 +1,112 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "../indexer/store.hpp"
+
+#include <vector>
+
+//an open addressed map from 64 bit keys, every entry inline in one array. Probing is linear
+//and erase shifts the run back, so lookups never step over tombstones
+namespace dconnect {
+
+   template<typename V>
+   class flat_map {
+      public:
+         explicit flat_map( size_t capacity = 16 ) {
+            size_t n = 16;
+            while( n < capacity * 2 ) {
+               n *= 2;
+            }
+            buckets.resize( n );
+         }
+
+         V* find( uint64_t key ) {
+            size_t i = home( key );
+            for( ;; i = ( i + 1 ) & mask() ) {
+               if( !buckets[i].used ) {
+                  return nullptr;
+               }
+               if( buckets[i].key == key ) {
+                  return &buckets[i].value;
+               }
+            }
+         }
+
+         //the value for key, default constructed if it wasn't there. Invalidated by the next insert
+         V& operator[]( uint64_t key ) {
+            if( ( count + 1 ) * 8 > buckets.size() * 7 ) {
+               rehash( buckets.size() * 2 );
+            }
+            size_t i = home( key );
+            for( ; buckets[i].used; i = ( i + 1 ) & mask() ) {
+               if( buckets[i].key == key ) {
+                  return buckets[i].value;
+               }
+            }
+            buckets[i].used = true;
+            buckets[i].key = key;
+            buckets[i].value = V();
+            count++;
+            return buckets[i].value;
+         }
+
+         void erase( uint64_t key ) {
+            size_t hole = home( key );
+            for( ; buckets[hole].used && buckets[hole].key != key; hole = ( hole + 1 ) & mask() ) {
+            }
+            if( !buckets[hole].used ) {
+               return;
+            }
+            for( size_t i = ( hole + 1 ) & mask(); buckets[i].used; i = ( i + 1 ) & mask() ) {
+               //an entry can fill the hole unless its home lies cyclically in (hole, i]
+               size_t h = home( buckets[i].key );
+               bool stays = hole <= i ? ( h > hole && h <= i ) : ( h > hole || h <= i );
+               if( !stays ) {
+                  buckets[hole] = buckets[i];
+                  hole = i;
+               }
+            }
+            buckets[hole].used = false;
+            count--;
+         }
+
+         template<typename F>
+         void for_each( F&& f ) const {
+            for( const auto& b : buckets ) {
+               if( b.used ) {
+                  f( b.key, b.value );
+               }
+            }
+         }
+
+         size_t size() const { return count; }
+
+      private:
+         struct bucket {
+            uint64_t key = 0;
+            V value{};
+            bool used = false;
+         };
+
+         size_t mask() const { return buckets.size() - 1; }
+         size_t home( uint64_t key ) const { return store::hash( kind::empty, key, 0 ) & mask(); }
+
+         void rehash( size_t n ) {
+            std::vector<bucket> old( n );
+            old.swap( buckets );
+            count = 0;
+            for( const auto& b : old ) {
+               if( b.used ) {
+                  ( *this )[b.key] = b.value;
+               }
+            }
+         }
+
+         std::vector<bucket> buckets;
+         size_t count = 0;
+   };
+
+}
@@ -0,0 +1,319 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "board.hpp"
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dconnect;
+
+static void usage() {
+   fprintf( stderr,
+            "usage: dconnect-leaderboard --traces FILE --socket PATH [options]\n"
+            "       dconnect-leaderboard --socket PATH --query \"BOARD N\"\n"
+            "       dconnect-leaderboard --socket PATH --bench N [--query \"BOARD N\"]\n"
+            "  BOARD is content (reward total), trending (hot score) or users (reward total)\n"
+            "  --contract NAME       account the token is deployed to (default dconnect)\n"
+            "  --symbol CODE         rank rewards in this token only (default every token)\n"
+            "  --top N               entries kept per board (default 100)\n"
+            "  --bench N             send N queries (default \"trending 10\") and print the latency percentiles\n"
+            "  --lock-period S       policy at the start of the traces, as in policy.hpp\n"
+            "  --payout-rate N\n"
+            "  --vote-rate N\n"
+            "  --rate-base N\n" );
+   exit( 2 );
+}
+
+static volatile sig_atomic_t stopping = 0;
+
+static void on_signal( int ) {
+   stopping = 1;
+}
+
+static sockaddr_un socket_address( const std::string& path ) {
+   sockaddr_un addr{};
+   addr.sun_family = AF_UNIX;
+   if( path.size() >= sizeof(addr.sun_path) ) {
+      throw std::runtime_error( "socket path too long" );
+   }
+   strcpy( addr.sun_path, path.c_str() );
+   return addr;
+}
+
+//one request per line, "BOARD N", answered with "RANK ID SCORE" lines and an empty line.
+//"status" is answered with the number of trace records applied so far
+static std::string answer( const leaderboard& lb, uint64_t records, const std::string& request ) {
+   if( request == "status" ) {
+      return "records " + std::to_string( records ) + "\n\n";
+   }
+   char board_name[16];
+   unsigned n;
+   leaderboard::board b;
+   if( sscanf( request.c_str(), "%15s %u", board_name, &n ) != 2 || !leaderboard::parse_board( board_name, b ) ) {
+      return "error: expected BOARD N\n\n";
+   }
+   std::string out;
+   char line[64];
+   unsigned rank = 1;
+   for( const auto& i : lb.top( b, n ) ) {
+      if( b == leaderboard::users ) {
+         snprintf( line, sizeof(line), "%u %s %llu\n", rank++, dconnect::name( i.key ).to_string().c_str(),
+                   (unsigned long long)i.score );
+      } else {
+         snprintf( line, sizeof(line), "%u %llu %llu\n", rank++, (unsigned long long)i.key, (unsigned long long)i.score );
+      }
+      out += line;
+   }
+   return out + "\n";
+}
+
+static int connect_to( const std::string& socket_path ) {
+   auto addr = socket_address( socket_path );
+   int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+   if( fd >= 0 && connect( fd, reinterpret_cast<sockaddr*>( &addr ), sizeof(addr) ) != 0 ) {
+      close( fd );
+      fd = -1;
+   }
+   if( fd < 0 ) {
+      fprintf( stderr, "cannot connect to %s\n", socket_path.c_str() );
+   }
+   return fd;
+}
+
+//sends one request and reads its response, returning the round trip in microseconds
+static double round_trip( int fd, const std::string& request, std::string& response ) {
+   std::string line = request + "\n";
+   response.clear();
+   auto start = std::chrono::steady_clock::now();
+   send( fd, line.data(), line.size(), 0 );
+   char buffer[4096];
+   while( response.size() < 2 || response.compare( response.size() - 2, 2, "\n\n" ) != 0 ) {
+      ssize_t n = recv( fd, buffer, sizeof(buffer), 0 );
+      if( n <= 0 ) {
+         throw std::runtime_error( "connection closed" );
+      }
+      response.append( buffer, n );
+   }
+   return std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count();
+}
+
+static int query( const std::string& socket_path, const std::string& request ) {
+   int fd = connect_to( socket_path );
+   if( fd < 0 ) {
+      return 1;
+   }
+   std::string response;
+   double us = round_trip( fd, request, response );
+   close( fd );
+   fputs( response.c_str(), stdout );
+   fprintf( stderr, "round trip %.1fus\n", us );
+   return 0;
+}
+
+//queries sent back to back over one connection. The records the service applied meanwhile are
+//reported with the percentiles, since latency while it is catching up on the traces is what counts
+static int bench( const std::string& socket_path, const std::string& request, size_t n ) {
+   int fd = connect_to( socket_path );
+   if( fd < 0 ) {
+      return 1;
+   }
+   std::string response;
+   round_trip( fd, "status", response );
+   uint64_t before = strtoull( response.c_str() + 8, nullptr, 10 );
+   std::vector<double> us( n );
+   for( size_t i = 0; i < n; i++ ) {
+      us[i] = round_trip( fd, request, response );
+      if( response.compare( 0, 6, "error:" ) == 0 ) {
+         fputs( response.c_str(), stderr );
+         close( fd );
+         return 1;
+      }
+   }
+   round_trip( fd, "status", response );
+   uint64_t after = strtoull( response.c_str() + 8, nullptr, 10 );
+   close( fd );
+
+   std::sort( us.begin(), us.end() );
+   auto percentile = [&]( double p ) { return us[std::min( n - 1, size_t( p * n ) )]; };
+   printf( "%zu queries of \"%s\" while %llu records were applied\n", n, request.c_str(), (unsigned long long)( after - before ) );
+   printf( "p50 %.1fus  p99 %.1fus  max %.1fus\n", percentile( 0.50 ), percentile( 0.99 ), us.back() );
+   return 0;
+}
+
+int main( int argc, char** argv ) {
+   std::string trace_path, socket_path, request, contract = "dconnect";
+   uint64_t code = 0;
+   size_t k = 100, bench_queries = 0;
+   region_header policy{};
+   policy.lock_period = 86400;
+   policy.payout_rate = 1009;
+   policy.vote_rate = 1001;
+   policy.rate_base = 1000;
+
+   for( int i = 1; i < argc; i++ ) {
+      std::string arg = argv[i];
+      if( i + 1 == argc ) {
+         usage();
+      }
+      const char* value = argv[++i];
+      if( arg == "--traces" ) trace_path = value;
+      else if( arg == "--socket" ) socket_path = value;
+      else if( arg == "--query" ) request = value;
+      else if( arg == "--contract" ) contract = value;
+      else if( arg == "--symbol" ) code = dconnect::symbol::code_from_string( value );
+      else if( arg == "--top" ) k = strtoull( value, nullptr, 10 );
+      else if( arg == "--bench" ) bench_queries = strtoull( value, nullptr, 10 );
+      else if( arg == "--lock-period" ) policy.lock_period = strtoul( value, nullptr, 10 );
+      else if( arg == "--payout-rate" ) policy.payout_rate = strtoll( value, nullptr, 10 );
+      else if( arg == "--vote-rate" ) policy.vote_rate = strtoll( value, nullptr, 10 );
+      else if( arg == "--rate-base" ) policy.rate_base = strtoll( value, nullptr, 10 );
+      else usage();
+   }
+   if( socket_path.empty() ) {
+      usage();
+   }
+   try {
+      if( bench_queries > 0 ) {
+         return bench( socket_path, request.empty() ? "trending 10" : request, bench_queries );
+      }
+      if( !request.empty() ) {
+         return query( socket_path, request );
+      }
+   } catch( const std::exception& e ) {
+      fprintf( stderr, "%s\n", e.what() );
+      return 1;
+   }
+   if( trace_path.empty() ) {
+      usage();
+   }
+
+   std::string store_path = socket_path + ".store";
+   int status = 0;
+   try {
+      struct stat st;
+      if( ::stat( store_path.c_str(), &st ) == 0 ) {
+         throw std::runtime_error( store_path + " already exists" );
+      }
+      store db( store_path, 1 << 16 );
+      db.meta() = policy;
+      state state( db, dconnect::name( contract ) );
+      leaderboard lb( k, code );
+      state.on_event = [&]( const event& e ) { lb.add( e ); };
+
+      auto addr = socket_address( socket_path );
+      ::unlink( socket_path.c_str() );
+      int listener = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0 );
+      if( listener < 0 || bind( listener, reinterpret_cast<sockaddr*>( &addr ), sizeof(addr) ) != 0 || listen( listener, 64 ) != 0 ) {
+         throw std::runtime_error( "cannot listen on " + socket_path );
+      }
+      signal( SIGINT, on_signal );
+      signal( SIGTERM, on_signal );
+      signal( SIGPIPE, SIG_IGN );
+
+      struct client {
+         int fd;
+         std::string pending;
+      };
+      std::vector<client> clients;
+      std::vector<pollfd> fds;
+      std::unique_ptr<trace_file> traces;
+      uint64_t offset = 0, records = 0;
+
+      while( !stopping ) {
+         //the trace file is followed as it grows, a bounded batch at a time so queries stay quick
+         if( ::stat( trace_path.c_str(), &st ) == 0 && ( !traces || uint64_t( st.st_size ) > traces->size() ) ) {
+            traces.reset( new trace_file( trace_path ) );
+         }
+         bool behind = false;
+         for( int n = 0; traces && n < 10000; n++ ) {
+            auto t = traces->at( offset );
+            if( !t ) {
+               break;
+            }
+            try {
+               state.apply( *t );
+            } catch( const std::exception& e ) {
+               throw std::runtime_error( "record " + std::to_string( records ) + " at offset " + std::to_string( offset ) +
+                                         " (" + t->action.to_string() + "): " + e.what() );
+            }
+            offset = t->end;
+            records++;
+            behind = true;
+            if( db.full() ) {
+               db.commit( offset, records );
+               db.grow();
+            }
+         }
+
+         fds.assign( 1, pollfd{ listener, POLLIN, 0 } );
+         for( const auto& c : clients ) {
+            fds.push_back( pollfd{ c.fd, POLLIN, 0 } );
+         }
+         if( poll( fds.data(), fds.size(), behind ? 0 : 100 ) < 0 ) {
+            continue;
+         }
+         if( fds[0].revents & POLLIN ) {
+            int fd;
+            while( ( fd = accept( listener, nullptr, nullptr ) ) >= 0 ) {
+               clients.push_back( client{ fd, std::string() } );
+            }
+         }
+         for( size_t i = 1; i < fds.size(); i++ ) {
+            if( !fds[i].revents ) {
+               continue;
+            }
+            auto& c = clients[i - 1];
+            char buffer[512];
+            ssize_t n = recv( c.fd, buffer, sizeof(buffer), MSG_DONTWAIT );
+            if( n <= 0 ) {
+               close( c.fd );
+               c.fd = -1;
+               continue;
+            }
+            c.pending.append( buffer, n );
+            size_t end;
+            while( ( end = c.pending.find( '\n' ) ) != std::string::npos ) {
+               std::string response = answer( lb, records, c.pending.substr( 0, end ) );
+               c.pending.erase( 0, end + 1 );
+               if( send( c.fd, response.data(), response.size(), MSG_NOSIGNAL ) != ssize_t( response.size() ) ) {
+                  close( c.fd );
+                  c.fd = -1;
+                  break;
+               }
+            }
+            if( c.fd >= 0 && c.pending.size() > 4096 ) {
+               close( c.fd );
+               c.fd = -1;
+            }
+         }
+         clients.erase( std::remove_if( clients.begin(), clients.end(), []( const client& c ) { return c.fd < 0; } ),
+                        clients.end() );
+      }
+      for( const auto& c : clients ) {
+         close( c.fd );
+      }
+      close( listener );
+      printf( "applied %llu records, %llu rewards over %zu contents and %zu users\n", (unsigned long long)records,
+              (unsigned long long)lb.rewards_seen(), lb.content_count(), lb.user_count() );
+   } catch( const std::exception& e ) {
+      fprintf( stderr, "%s\n", e.what() );
+      status = 1;
+   }
+   ::unlink( socket_path.c_str() );
+   ::unlink( store_path.c_str() );
+   return status;
+}
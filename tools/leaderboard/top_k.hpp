@@ -0,0 +1,99 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "flat_map.hpp"
+
+#include <algorithm>
+
+//the k best keys by a score that only ever goes up, as reward totals and hot scores do. The
+//k are kept in a min heap, so the worst of them is at the top. A key outside the heap was no
+//better than that worst one when last updated, and the worst one only gets better, so an
+//update only has to compare against the top
+namespace dconnect {
+
+   class top_k {
+      public:
+         struct item {
+            uint64_t score;
+            uint64_t key;
+         };
+
+         explicit top_k( size_t k ) : k( k ), positions( k ) { heap.reserve( k ); }
+
+         void update( uint64_t key, uint64_t score ) {
+            if( uint32_t* pos = positions.find( key ) ) {
+               heap[*pos].score = score;
+               sift_down( *pos );
+               return;
+            }
+            if( heap.size() < k ) {
+               heap.push_back( item{ score, key } );
+               positions[key] = heap.size() - 1;
+               sift_up( heap.size() - 1 );
+            } else if( k > 0 && better( item{ score, key }, heap[0] ) ) {
+               positions.erase( heap[0].key );
+               heap[0] = item{ score, key };
+               positions[key] = 0;
+               sift_down( 0 );
+            }
+         }
+
+         //the best n, best first
+         std::vector<item> top( size_t n ) const {
+            std::vector<item> out( heap );
+            n = std::min( n, out.size() );
+            std::partial_sort( out.begin(), out.begin() + n, out.end(), better );
+            out.resize( n );
+            return out;
+         }
+
+         size_t capacity() const { return k; }
+
+      private:
+         //ties go to the lower key, so the order is the same however the updates arrived
+         static bool better( const item& a, const item& b ) {
+            return a.score > b.score || ( a.score == b.score && a.key < b.key );
+         }
+
+         void sift_up( size_t i ) {
+            while( i > 0 ) {
+               size_t parent = ( i - 1 ) / 2;
+               if( !better( heap[parent], heap[i] ) ) {
+                  break;
+               }
+               swap( i, parent );
+               i = parent;
+            }
+         }
+
+         void sift_down( size_t i ) {
+            for( ;; ) {
+               size_t worst = i;
+               for( size_t c = 2 * i + 1; c <= 2 * i + 2 && c < heap.size(); c++ ) {
+                  if( better( heap[worst], heap[c] ) ) {
+                     worst = c;
+                  }
+               }
+               if( worst == i ) {
+                  return;
+               }
+               swap( i, worst );
+               i = worst;
+            }
+         }
+
+         void swap( size_t a, size_t b ) {
+            std::swap( heap[a], heap[b] );
+            positions[heap[a].key] = a;
+            positions[heap[b].key] = b;
+         }
+
+         size_t k;
+         std::vector<item> heap;
+         flat_map<uint32_t> positions;
+   };
+
+}
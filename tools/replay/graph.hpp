@@ -0,0 +1,236 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "../indexer/state.hpp"
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+//orders a run of traces by the rows each one reads and writes. A trace depends on the last
+//earlier writer of every scope it touches, and a write also waits for the readers since, so
+//any order that respects the edges leaves the same state as applying the traces in file order
+namespace dconnect {
+
+   class replay_graph {
+      public:
+         replay_graph( dconnect::name contract, uint64_t reward_tail ) : contract( contract ), reward_tail( reward_tail ) {}
+
+         void add( const trace& t ) {
+            uint32_t node = traces.size();
+            traces.push_back( t );
+            reward_keys.push_back( reward_tail );
+            barriers.push_back( false );
+            deps.push_back( 0 );
+
+            if( !plan( node, t ) ) {
+               //settlement and imports reach rows all over the store, so they run alone
+               barriers[node] = true;
+               for( uint32_t n = last_barrier == none ? 0 : last_barrier; n < node; n++ ) {
+                  edge( n, node );
+               }
+               scopes.clear();
+               last_barrier = node;
+            } else if( last_barrier != none ) {
+               edge( last_barrier, node );
+            }
+         }
+
+         //lays the edges out by source once every trace is added
+         void finish() {
+            first.assign( traces.size() + 1, 0 );
+            for( const auto& e : edges ) {
+               first[e.first + 1]++;
+            }
+            for( size_t i = 1; i < first.size(); i++ ) {
+               first[i] += first[i - 1];
+            }
+            targets.resize( edges.size() );
+            std::vector<uint32_t> fill( first.begin(), first.end() - 1 );
+            for( const auto& e : edges ) {
+               targets[fill[e.first]++] = e.second;
+            }
+            edges.clear();
+            edges.shrink_to_fit();
+            scopes.clear();
+         }
+
+         size_t size() const { return traces.size(); }
+         const trace& at( uint32_t node ) const { return traces[node]; }
+         bool barrier( uint32_t node ) const { return barriers[node]; }
+         uint32_t dependencies( uint32_t node ) const { return deps[node]; }
+
+         //the key a reward queues under, or for a barrier the next key as of that trace
+         uint64_t reward_key( uint32_t node ) const { return reward_keys[node]; }
+         uint64_t final_reward_tail() const { return reward_tail; }
+
+         template<typename F>
+         void for_each_dependent( uint32_t node, F&& f ) const {
+            for( uint32_t i = first[node]; i < first[node + 1]; i++ ) {
+               f( targets[i] );
+            }
+         }
+
+      private:
+         static constexpr uint32_t none = ~0u;
+
+         //the payout queue's tail and per owner index, which aren't rows of their own
+         static constexpr uint32_t payout_queue = 100;
+
+         struct scope_key {
+            uint32_t tag;
+            uint64_t k1;
+            uint64_t k2;
+
+            bool operator==( const scope_key& o ) const { return tag == o.tag && k1 == o.k1 && k2 == o.k2; }
+         };
+
+         struct scope_hash {
+            size_t operator()( const scope_key& k ) const { return store::hash( dconnect::kind( k.tag ), k.k1, k.k2 ); }
+         };
+
+         struct access {
+            uint32_t writer = none;
+            std::vector<uint32_t> readers;
+         };
+
+         //records the trace's reads and writes, or returns false if it must run as a barrier
+         bool plan( uint32_t node, const trace& t ) {
+            try {
+               reader r( t.data, t.size );
+               if( t.account != contract ) {
+                  if( t.action.value == actions::transfer ) {
+                     auto from = r.read_name();
+                     auto to = r.read_name();
+                     auto quantity = r.read_asset();
+                     uint64_t code = bounty_code( contract, from, to, quantity, r.read_string() );
+                     if( code != 0 ) {
+                        write( node, uint32_t( kind::stat ), code, 0 );
+                     }
+                  }
+                  return true;
+               }
+               switch( t.action.value ) {
+                  case actions::transfer: {
+                     auto from = r.read_name();
+                     auto to = r.read_name();
+                     auto sym = r.read_asset().symbol.code();
+                     read( node, uint32_t( kind::stat ), sym, 0 );
+                     write( node, uint32_t( kind::balance ), from.value, sym );
+                     write( node, uint32_t( kind::balance ), to.value, sym );
+                     return true;
+                  }
+                  case actions::reward: {
+                     auto to = r.read_name();
+                     r.read_name();
+                     auto sym = r.read_asset().symbol.code();
+                     r.read_string();
+                     auto content = r.read<int64_t>();
+                     //rewards queue under keys handed out here rather than at the queue's tail, so
+                     //they only contend per owner and content. The policy changes only in a barrier
+                     read( node, uint32_t( kind::stat ), sym, 0 );
+                     write( node, uint32_t( kind::balance ), to.value, sym );
+                     write( node, uint32_t( kind::pending ), to.value, sym );
+                     write( node, uint32_t( kind::user_total ), to.value, sym );
+                     write( node, uint32_t( kind::content_total ), uint64_t( content ), 0 );
+                     reward_tail++;
+                     return true;
+                  }
+                  case actions::retire: {
+                     auto to = r.read_name();
+                     auto sym = r.read_asset().symbol.code();
+                     write( node, uint32_t( kind::stat ), sym, 0 );
+                     write( node, uint32_t( kind::balance ), to.value, sym );
+                     write( node, payout_queue, 0, 0 );
+                     return true;
+                  }
+                  case actions::open: {
+                     auto owner = r.read_name();
+                     auto sym = r.read_symbol().code();
+                     read( node, uint32_t( kind::stat ), sym, 0 );
+                     write( node, uint32_t( kind::balance ), owner.value, sym );
+                     return true;
+                  }
+                  case actions::close: {
+                     auto owner = r.read_name();
+                     write( node, uint32_t( kind::balance ), owner.value, r.read_symbol().code() );
+                     return true;
+                  }
+                  case actions::importrows: {
+                     //imported rewards keep their keys, and later rewards queue past the highest
+                     uint64_t table = r.read_name().value;
+                     auto rows = r.read_string();
+                     size_t size = 8 + payout_view::packed_size;
+                     for( size_t pos = 0; table == tables::payouts && pos + size <= rows.size(); pos += size ) {
+                        payout_view v( rows.data() + pos + 8, payout_view::packed_size );
+                        uint64_t scope;
+                        memcpy( &scope, rows.data() + pos, sizeof(scope) );
+                        if( scope == tables::rewards ) {
+                           reward_tail = std::max( reward_tail, v.pk() + 1 );
+                        }
+                     }
+                     return false;
+                  }
+                  case actions::pay:
+                  case actions::crank:
+                  case actions::issue:
+                  case actions::create:
+                  case actions::setconfig:
+                     return false;
+               }
+               return true;
+            } catch( const decode_error& ) {
+               //applying it will fail, in order
+               return false;
+            }
+         }
+
+         void read( uint32_t node, uint32_t tag, uint64_t k1, uint64_t k2 ) {
+            auto& a = scopes[scope_key{ tag, k1, k2 }];
+            if( a.writer != none ) {
+               edge( a.writer, node );
+            }
+            a.readers.push_back( node );
+         }
+
+         void write( uint32_t node, uint32_t tag, uint64_t k1, uint64_t k2 ) {
+            auto& a = scopes[scope_key{ tag, k1, k2 }];
+            if( a.writer != none ) {
+               edge( a.writer, node );
+            }
+            for( uint32_t reader : a.readers ) {
+               if( reader != node ) {
+                  edge( reader, node );
+               }
+            }
+            a.readers.clear();
+            a.writer = node;
+         }
+
+         void edge( uint32_t from, uint32_t to ) {
+            if( from == to ) {
+               return;
+            }
+            edges.emplace_back( from, to );
+            deps[to]++;
+         }
+
+         dconnect::name contract;
+         uint64_t reward_tail;
+         uint32_t last_barrier = none;
+
+         std::vector<trace> traces;
+         std::vector<uint64_t> reward_keys;
+         std::vector<bool> barriers;
+         std::vector<uint32_t> deps;
+         std::vector<std::pair<uint32_t, uint32_t>> edges;
+         std::vector<uint32_t> first;
+         std::vector<uint32_t> targets;
+         std::unordered_map<scope_key, access, scope_hash> scopes;
+   };
+
+}
@@ -0,0 +1,181 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "memory_store.hpp"
+#include "pool.hpp"
+
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace dconnect;
+
+typedef basic_state<memory_store> memory_state;
+
+static void usage() {
+   fprintf( stderr,
+            "usage: dconnect-replay --traces FILE [options]\n"
+            "  --contract NAME       account the token is deployed to (default dconnect)\n"
+            "  --threads N           replay threads (default one per core)\n"
+            "  --verify              also replay on one thread and check the states match\n"
+            "  --store FILE          save the result as a new indexer store\n"
+            "  --lock-period S       policy at the start of the traces, as in policy.hpp\n"
+            "  --payout-rate N\n"
+            "  --vote-rate N\n"
+            "  --rate-base N\n" );
+   exit( 2 );
+}
+
+//applies the traces in file order, and says where it stops if one fails
+static bool replay_serial( const trace_file& traces, memory_store& db, dconnect::name contract ) {
+   memory_state st( db, contract );
+   uint64_t offset = 0, records = 0;
+   while( auto t = traces.at( offset ) ) {
+      try {
+         st.apply( *t );
+      } catch( const std::exception& e ) {
+         fprintf( stderr, "record %llu at offset %llu (%s): %s\n", (unsigned long long)records,
+                  (unsigned long long)offset, t->action.to_string().c_str(), e.what() );
+         return false;
+      }
+      offset = t->end;
+      records++;
+   }
+   return true;
+}
+
+static bool same_state( const memory_store& a, memory_store& b ) {
+   if( a.used() != b.used() || memcmp( &a.meta(), &b.meta(), sizeof(region_header) ) != 0 ) {
+      return false;
+   }
+   bool same = true;
+   a.for_each( [&]( const slot& s ) {
+      auto* p = b.find<decltype(s.payload)>( s.kind, s.k1, s.k2 );
+      same = same && p && memcmp( p, s.payload, sizeof(s.payload) ) == 0;
+   });
+   return same;
+}
+
+static void save( const memory_store& db, const std::string& path, uint64_t offset, uint64_t records ) {
+   struct stat st;
+   if( ::stat( path.c_str(), &st ) == 0 ) {
+      throw std::runtime_error( path + " already exists" );
+   }
+   uint64_t capacity = 1024;
+   while( capacity < db.used() * 2 ) {
+      capacity *= 2;
+   }
+   store out( path, capacity );
+   uint64_t used = out.meta().used;
+   out.meta() = db.meta();
+   out.meta().used = used;
+   db.for_each( [&]( const slot& s ) {
+      memcpy( out.upsert<decltype(s.payload)>( s.kind, s.k1, s.k2 ), s.payload, sizeof(s.payload) );
+   });
+   out.commit( offset, records );
+}
+
+int main( int argc, char** argv ) {
+   std::string trace_path, store_path, contract = "dconnect";
+   unsigned threads = std::thread::hardware_concurrency();
+   bool verify = false;
+   region_header policy{};
+   policy.lock_period = 86400;
+   policy.payout_rate = 1009;
+   policy.vote_rate = 1001;
+   policy.rate_base = 1000;
+
+   for( int i = 1; i < argc; i++ ) {
+      std::string arg = argv[i];
+      if( arg == "--verify" ) {
+         verify = true;
+         continue;
+      }
+      if( i + 1 == argc ) {
+         usage();
+      }
+      const char* value = argv[++i];
+      if( arg == "--traces" ) trace_path = value;
+      else if( arg == "--store" ) store_path = value;
+      else if( arg == "--contract" ) contract = value;
+      else if( arg == "--threads" ) threads = strtoul( value, nullptr, 10 );
+      else if( arg == "--lock-period" ) policy.lock_period = strtoul( value, nullptr, 10 );
+      else if( arg == "--payout-rate" ) policy.payout_rate = strtoll( value, nullptr, 10 );
+      else if( arg == "--vote-rate" ) policy.vote_rate = strtoll( value, nullptr, 10 );
+      else if( arg == "--rate-base" ) policy.rate_base = strtoll( value, nullptr, 10 );
+      else usage();
+   }
+   if( trace_path.empty() ) {
+      usage();
+   }
+
+   try {
+      trace_file traces( trace_path );
+      dconnect::name account( contract );
+      memory_store db;
+      db.meta() = policy;
+
+      auto start = std::chrono::steady_clock::now();
+      replay_graph g( account, db.meta().reward_tail );
+      uint64_t offset = 0;
+      while( auto t = traces.at( offset ) ) {
+         g.add( *t );
+         offset = t->end;
+      }
+      g.finish();
+
+      work_pool pool( threads );
+      std::vector<memory_state> states;
+      for( unsigned t = 0; t < pool.size(); t++ ) {
+         states.emplace_back( db, account );
+      }
+      try {
+         pool.run( g, [&]( uint32_t node, unsigned thread ) {
+            if( g.barrier( node ) ) {
+               //runs alone, so the queue tail can catch up with the keys handed out so far
+               db.meta().reward_tail = g.reward_key( node );
+               states[thread].apply( g.at( node ) );
+            } else {
+               states[thread].apply( g.at( node ), g.reward_key( node ) );
+            }
+         });
+      } catch( const work_pool::replay_error& e ) {
+         //serial replay stops at the first failing trace, and that is the one to report
+         memory_store serial;
+         serial.meta() = policy;
+         if( replay_serial( traces, serial, account ) ) {
+            fprintf( stderr, "record %u: %s\n", e.node, e.what() );
+         }
+         return 1;
+      }
+      db.meta().reward_tail = g.final_reward_tail();
+      double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      printf( "replayed %zu records on %u threads in %.3fs, %llu slots\n", g.size(), pool.size(), seconds,
+              (unsigned long long)db.used() );
+
+      if( verify ) {
+         memory_store serial;
+         serial.meta() = policy;
+         if( !replay_serial( traces, serial, account ) ) {
+            return 1;
+         }
+         if( !same_state( serial, db ) ) {
+            fprintf( stderr, "parallel and serial replay disagree\n" );
+            return 1;
+         }
+         printf( "matches serial replay\n" );
+      }
+      if( !store_path.empty() ) {
+         save( db, store_path, offset, g.size() );
+      }
+   } catch( const std::exception& e ) {
+      fprintf( stderr, "%s\n", e.what() );
+      return 1;
+   }
+   return 0;
+}
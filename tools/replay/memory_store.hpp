@@ -0,0 +1,104 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "../indexer/store.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+//the indexer store's interface over sharded in-memory maps, for replay on several threads.
+//Each call locks one shard, and a payload stays put until its slot is erased, so threads
+//may hold payloads of different slots at once. Ordering access to the same slot is up to the caller
+namespace dconnect {
+
+   class memory_store {
+      public:
+         explicit memory_store( size_t shard_count = 64 ) : shard_count( shard_count ), shards( new shard[shard_count] ) {}
+
+         template<typename T>
+         T* find( dconnect::kind k, uint64_t k1, uint64_t k2 ) {
+            static_assert( sizeof(T) <= sizeof(slot::payload), "payload too large for a slot" );
+            slot_key key{ k, k1, k2 };
+            auto& sh = shard_of( key );
+            std::lock_guard<std::mutex> lock( sh.mutex );
+            auto itr = sh.slots.find( key );
+            return itr == sh.slots.end() ? nullptr : reinterpret_cast<T*>( itr->second.payload );
+         }
+
+         template<typename T>
+         T& upsert( dconnect::kind k, uint64_t k1, uint64_t k2, bool* created = nullptr ) {
+            static_assert( sizeof(T) <= sizeof(slot::payload), "payload too large for a slot" );
+            slot_key key{ k, k1, k2 };
+            auto& sh = shard_of( key );
+            std::lock_guard<std::mutex> lock( sh.mutex );
+            auto result = sh.slots.try_emplace( key );
+            slot& s = result.first->second;
+            if( result.second ) {
+               memset( &s, 0, sizeof(s) );
+               s.kind = k;
+               s.k1 = k1;
+               s.k2 = k2;
+               count++;
+            }
+            if( created ) {
+               *created = result.second;
+            }
+            return *reinterpret_cast<T*>( s.payload );
+         }
+
+         void erase( dconnect::kind k, uint64_t k1, uint64_t k2 ) {
+            slot_key key{ k, k1, k2 };
+            auto& sh = shard_of( key );
+            std::lock_guard<std::mutex> lock( sh.mutex );
+            count -= sh.slots.erase( key );
+         }
+
+         //not safe to call while other threads change the store
+         template<typename F>
+         void for_each( F&& f ) const {
+            for( size_t i = 0; i < shard_count; i++ ) {
+               for( const auto& s : shards[i].slots ) {
+                  f( s.second );
+               }
+            }
+         }
+
+         region_header& meta() { return header; }
+         const region_header& meta() const { return header; }
+         uint64_t used() const { return count; }
+
+      private:
+         struct slot_key {
+            dconnect::kind kind;
+            uint64_t k1;
+            uint64_t k2;
+
+            bool operator==( const slot_key& o ) const { return kind == o.kind && k1 == o.k1 && k2 == o.k2; }
+         };
+
+         struct slot_hash {
+            size_t operator()( const slot_key& k ) const { return store::hash( k.kind, k.k1, k.k2 ); }
+         };
+
+         struct shard {
+            std::mutex mutex;
+            std::unordered_map<slot_key, slot, slot_hash> slots;
+         };
+
+         //the low bits pick the bucket within a shard, so the shard comes from the high ones
+         shard& shard_of( const slot_key& key ) {
+            return shards[( store::hash( key.kind, key.k1, key.k2 ) >> 40 ) % shard_count];
+         }
+
+         size_t shard_count;
+         std::unique_ptr<shard[]> shards;
+         std::atomic<uint64_t> count{ 0 };
+         region_header header{};
+   };
+
+}
@@ -0,0 +1,133 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "graph.hpp"
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//runs a replay graph on a fixed set of threads. Each thread works the newest end of its
+//own deque, where the traces it just unblocked land, and steals the oldest from others
+namespace dconnect {
+
+   class work_pool {
+      public:
+         explicit work_pool( unsigned threads ) : workers( threads ? threads : 1 ) {}
+
+         //calls work( node, thread ) for every node once its dependencies are done. An exception
+         //stops the run and the earliest failing node seen is rethrown as a replay_error
+         template<typename F>
+         void run( const replay_graph& g, F&& work ) {
+            size_t n = g.size();
+            waiting.reset( new std::atomic<uint32_t>[n] );
+            remaining = n;
+            failed = false;
+            failed_node = ~0u;
+            for( size_t i = 0; i < n; i++ ) {
+               waiting[i].store( g.dependencies( i ), std::memory_order_relaxed );
+            }
+            for( auto& w : workers ) {
+               w.ready.clear();
+            }
+            size_t next = 0;
+            for( uint32_t i = 0; i < n; i++ ) {
+               if( g.dependencies( i ) == 0 ) {
+                  workers[next++ % workers.size()].ready.push_back( i );
+               }
+            }
+
+            std::vector<std::thread> threads;
+            for( unsigned t = 1; t < workers.size(); t++ ) {
+               threads.emplace_back( [&, t] { loop( g, work, t ); } );
+            }
+            loop( g, work, 0 );
+            for( auto& t : threads ) {
+               t.join();
+            }
+            if( failed ) {
+               throw replay_error( failed_node, failure );
+            }
+         }
+
+         struct replay_error : std::runtime_error {
+            replay_error( uint32_t node, const std::string& what ) : std::runtime_error( what ), node( node ) {}
+            uint32_t node;
+         };
+
+         unsigned size() const { return workers.size(); }
+
+      private:
+         struct worker {
+            std::mutex mutex;
+            std::deque<uint32_t> ready;
+         };
+
+         template<typename F>
+         void loop( const replay_graph& g, F& work, unsigned self ) {
+            while( remaining.load( std::memory_order_acquire ) > 0 && !failed.load( std::memory_order_relaxed ) ) {
+               uint32_t node;
+               if( !take( self, node ) ) {
+                  std::this_thread::yield();
+                  continue;
+               }
+               try {
+                  work( node, self );
+               } catch( const std::exception& e ) {
+                  fail( node, e.what() );
+                  return;
+               }
+               g.for_each_dependent( node, [&]( uint32_t d ) {
+                  if( waiting[d].fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+                     std::lock_guard<std::mutex> lock( workers[self].mutex );
+                     workers[self].ready.push_back( d );
+                  }
+               });
+               remaining.fetch_sub( 1, std::memory_order_acq_rel );
+            }
+         }
+
+         bool take( unsigned self, uint32_t& node ) {
+            {
+               std::lock_guard<std::mutex> lock( workers[self].mutex );
+               if( !workers[self].ready.empty() ) {
+                  node = workers[self].ready.back();
+                  workers[self].ready.pop_back();
+                  return true;
+               }
+            }
+            for( unsigned i = 1; i < workers.size(); i++ ) {
+               auto& victim = workers[( self + i ) % workers.size()];
+               std::lock_guard<std::mutex> lock( victim.mutex );
+               if( !victim.ready.empty() ) {
+                  node = victim.ready.front();
+                  victim.ready.pop_front();
+                  return true;
+               }
+            }
+            return false;
+         }
+
+         void fail( uint32_t node, const char* what ) {
+            std::lock_guard<std::mutex> lock( failure_mutex );
+            if( node < failed_node ) {
+               failed_node = node;
+               failure = what;
+            }
+            failed = true;
+         }
+
+         std::deque<worker> workers;
+         std::unique_ptr<std::atomic<uint32_t>[]> waiting;
+         std::atomic<size_t> remaining{ 0 };
+         std::atomic<bool> failed{ false };
+         std::mutex failure_mutex;
+         uint32_t failed_node = ~0u;
+         std::string failure;
+   };
+
+}
@@ -0,0 +1,123 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "eosiolib/name.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+//the node the contract runs against when it is built for the host: its tables, the action
+//being applied and what that action cost. The eosiolib headers next to this one read and
+//write it in place of the node's intrinsics
+namespace eosio { namespace sim {
+
+   //what one action did to the database and sent out. db_ops counts every database call the
+   //action would make on a node, reads, secondary index upkeep and all; writes counts only the
+   //rows it stored, updated or removed
+   struct action_costs {
+      uint64_t db_ops = 0;
+      uint64_t writes = 0;
+      uint64_t bytes_written = 0;
+      uint64_t inline_actions = 0;
+      uint64_t deferred = 0;
+
+      action_costs& operator+=( const action_costs& c ) {
+         db_ops += c.db_ops;
+         writes += c.writes;
+         bytes_written += c.bytes_written;
+         inline_actions += c.inline_actions;
+         deferred += c.deferred;
+         return *this;
+      }
+   };
+
+   struct sent_action {
+      name account;
+      name action;
+      std::vector<name> actors;
+      std::vector<char> data;
+   };
+
+   struct table_id {
+      uint64_t code;
+      uint64_t scope;
+      uint64_t table;
+
+      friend bool operator<( const table_id& a, const table_id& b ) {
+         return std::tie( a.code, a.scope, a.table ) < std::tie( b.code, b.scope, b.table );
+      }
+   };
+
+   //packed rows by primary key
+   typedef std::map<uint64_t, std::vector<char>> table_rows;
+   //( secondary key, primary key ) pairs of one index
+   typedef std::set<std::pair<uint64_t, uint64_t>> index_keys;
+
+   struct database {
+      std::map<table_id, table_rows> tables;
+      std::map<table_id, index_keys> indices;
+
+      const table_rows* find( const table_id& t ) const {
+         auto itr = tables.find( t );
+         return itr == tables.end() ? nullptr : &itr->second;
+      }
+
+      //tables are dropped once their last row is, so two databases holding the same rows compare equal
+      void drop_if_empty( const table_id& t ) {
+         auto itr = tables.find( t );
+         if( itr != tables.end() && itr->second.empty() ) {
+            tables.erase( itr );
+         }
+      }
+   };
+
+   struct chain_state {
+      database db;
+      uint32_t now = 1546300800;
+      name receiver;
+      std::set<uint64_t> auths;
+      std::vector<char> action_data;
+      action_costs costs;
+      std::vector<sent_action> inline_actions;
+      std::vector<sent_action> deferred;
+      std::string console;
+   };
+
+   inline chain_state& chain() {
+      static chain_state c;
+      return c;
+   }
+
+} }
+
+//the intrinsics the contract calls outside the eosio namespace
+inline uint32_t now() {
+   return eosio::sim::chain().now;
+}
+
+inline uint64_t current_time() {
+   return uint64_t( eosio::sim::chain().now ) * 1000000;
+}
+
+inline uint64_t current_receiver() {
+   return eosio::sim::chain().receiver.value;
+}
+
+inline uint32_t action_data_size() {
+   return eosio::sim::chain().action_data.size();
+}
+
+inline uint32_t read_action_data( void* msg, uint32_t len ) {
+   auto& data = eosio::sim::chain().action_data;
+   uint32_t n = std::min<size_t>( len, data.size() );
+   memcpy( msg, data.data(), n );
+   return n;
+}
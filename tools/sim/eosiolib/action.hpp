@@ -0,0 +1,108 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "datastream.hpp"
+#include "../chain.hpp"
+
+namespace eosio {
+
+   struct permission_level {
+      permission_level( name a, name p ) : actor( a ), permission( p ) {}
+      permission_level() {}
+
+      name actor;
+      name permission;
+
+      friend bool operator==( const permission_level& a, const permission_level& b ) {
+         return a.actor == b.actor && a.permission == b.permission;
+      }
+   };
+
+   template<typename Stream>
+   datastream<Stream>& operator<<( datastream<Stream>& ds, const permission_level& v ) {
+      return ds << v.actor << v.permission;
+   }
+
+   template<typename Stream>
+   datastream<Stream>& operator>>( datastream<Stream>& ds, permission_level& v ) {
+      return ds >> v.actor >> v.permission;
+   }
+
+   inline void require_auth( name n ) {
+      eosio_assert( sim::chain().auths.count( n.value ) > 0, ( "missing authority of " + n.to_string() ).c_str() );
+   }
+
+   inline bool has_auth( name n ) {
+      return sim::chain().auths.count( n.value ) > 0;
+   }
+
+   //every account exists on the simulated chain
+   inline bool is_account( name ) {
+      return true;
+   }
+
+   //notified accounts run no code in the simulator
+   inline void require_recipient( name ) {}
+
+   struct action {
+      eosio::name account;
+      eosio::name name;
+      std::vector<permission_level> authorization;
+      std::vector<char> data;
+
+      action() = default;
+
+      template<typename T>
+      action( const permission_level& auth, eosio::name a, eosio::name n, T&& value )
+         : account( a ), name( n ), authorization( 1, auth ), data( pack( std::forward<T>( value ) ) ) {}
+
+      template<typename T>
+      action( std::vector<permission_level> auths, eosio::name a, eosio::name n, T&& value )
+         : account( a ), name( n ), authorization( std::move( auths ) ), data( pack( std::forward<T>( value ) ) ) {}
+
+      sim::sent_action sent() const {
+         sim::sent_action s{ account, name, {}, data };
+         for( const auto& p : authorization ) {
+            s.actors.push_back( p.actor );
+         }
+         return s;
+      }
+
+      //the tester runs inline actions to this contract once the action that sent them returns
+      void send() const {
+         sim::chain().costs.inline_actions++;
+         sim::chain().inline_actions.push_back( sent() );
+      }
+
+      template<typename T>
+      T data_as() {
+         return unpack<T>( data );
+      }
+   };
+
+   template<typename T, name::raw Name>
+   struct inline_dispatcher;
+
+   template<typename T, name::raw Name, typename... Args>
+   struct inline_dispatcher<void ( T::* )( Args... ), Name> {
+      static void call( name code, const permission_level& perm, std::tuple<std::decay_t<Args>...> args ) {
+         action( perm, code, eosio::name( Name ), std::move( args ) ).send();
+      }
+      static void call( name code, std::vector<permission_level> perms, std::tuple<std::decay_t<Args>...> args ) {
+         action( std::move( perms ), code, eosio::name( Name ), std::move( args ) ).send();
+      }
+   };
+
+}
+
+#define INLINE_ACTION_SENDER3( CONTRACT_ACCOUNT, FUNCTION_NAME, ACTION_NAME ) \
+   ::eosio::inline_dispatcher<decltype( &FUNCTION_NAME ), ACTION_NAME>::call
+#define INLINE_ACTION_SENDER2( CONTRACT_CLASS, NAME ) \
+   INLINE_ACTION_SENDER3( CONTRACT_CLASS, CONTRACT_CLASS::NAME, ::eosio::name( #NAME ) )
+#define INLINE_ACTION_SENDER( CONTRACT_CLASS, NAME ) INLINE_ACTION_SENDER2( CONTRACT_CLASS, NAME )
+
+#define SEND_INLINE_ACTION( CONTRACT, NAME, ... ) \
+   INLINE_ACTION_SENDER( std::decay_t<decltype( CONTRACT )>, NAME )( ( CONTRACT ).get_self(), __VA_ARGS__ );
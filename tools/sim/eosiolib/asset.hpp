@@ -0,0 +1,132 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "symbol.hpp"
+
+#include <limits>
+
+namespace eosio {
+
+   struct asset {
+      static constexpr int64_t max_amount = ( 1LL << 62 ) - 1;
+
+      int64_t amount = 0;
+      eosio::symbol symbol;
+
+      asset() {}
+
+      asset( int64_t a, class symbol s ) : amount( a ), symbol{ s } {
+         eosio_assert( is_amount_within_range(), "magnitude of asset amount must be less than 2^62" );
+         eosio_assert( symbol.is_valid(), "invalid symbol name" );
+      }
+
+      bool is_amount_within_range() const { return -max_amount <= amount && amount <= max_amount; }
+      bool is_valid() const { return is_amount_within_range() && symbol.is_valid(); }
+
+      void set_amount( int64_t a ) {
+         amount = a;
+         eosio_assert( is_amount_within_range(), "magnitude of asset amount must be less than 2^62" );
+      }
+
+      asset operator-() const {
+         asset r = *this;
+         r.amount = -r.amount;
+         return r;
+      }
+
+      asset& operator-=( const asset& a ) {
+         eosio_assert( a.symbol == symbol, "attempt to subtract asset with different symbol" );
+         amount -= a.amount;
+         eosio_assert( -max_amount <= amount, "subtraction underflow" );
+         eosio_assert( amount <= max_amount, "subtraction overflow" );
+         return *this;
+      }
+
+      asset& operator+=( const asset& a ) {
+         eosio_assert( a.symbol == symbol, "attempt to add asset with different symbol" );
+         amount += a.amount;
+         eosio_assert( -max_amount <= amount, "addition underflow" );
+         eosio_assert( amount <= max_amount, "addition overflow" );
+         return *this;
+      }
+
+      inline friend asset operator+( const asset& a, const asset& b ) {
+         asset result = a;
+         result += b;
+         return result;
+      }
+
+      inline friend asset operator-( const asset& a, const asset& b ) {
+         asset result = a;
+         result -= b;
+         return result;
+      }
+
+      asset& operator*=( int64_t a ) {
+         __int128 tmp = (__int128)amount * (__int128)a;
+         eosio_assert( tmp <= max_amount, "multiplication overflow" );
+         eosio_assert( tmp >= -max_amount, "multiplication underflow" );
+         amount = (int64_t)tmp;
+         return *this;
+      }
+
+      friend asset operator*( const asset& a, int64_t b ) {
+         asset result = a;
+         result *= b;
+         return result;
+      }
+
+      asset& operator/=( int64_t a ) {
+         eosio_assert( a != 0, "divide by zero" );
+         eosio_assert( !( amount == std::numeric_limits<int64_t>::min() && a == -1 ), "signed division overflow" );
+         amount /= a;
+         return *this;
+      }
+
+      friend asset operator/( const asset& a, int64_t b ) {
+         asset result = a;
+         result /= b;
+         return result;
+      }
+
+      friend bool operator==( const asset& a, const asset& b ) {
+         eosio_assert( a.symbol == b.symbol, "comparison of assets with different symbols is not allowed" );
+         return a.amount == b.amount;
+      }
+
+      friend bool operator!=( const asset& a, const asset& b ) { return !( a == b ); }
+
+      friend bool operator<( const asset& a, const asset& b ) {
+         eosio_assert( a.symbol == b.symbol, "comparison of assets with different symbols is not allowed" );
+         return a.amount < b.amount;
+      }
+
+      friend bool operator<=( const asset& a, const asset& b ) {
+         eosio_assert( a.symbol == b.symbol, "comparison of assets with different symbols is not allowed" );
+         return a.amount <= b.amount;
+      }
+
+      friend bool operator>( const asset& a, const asset& b ) { return !( a <= b ); }
+      friend bool operator>=( const asset& a, const asset& b ) { return !( a < b ); }
+
+      std::string to_string() const {
+         int64_t p = symbol.precision();
+         int64_t p10 = 1;
+         for( int64_t i = 0; i < p; i++ ) {
+            p10 *= 10;
+         }
+         bool negative = amount < 0;
+         uint64_t whole = ( negative ? -(uint64_t)amount : (uint64_t)amount );
+         std::string fraction = std::to_string( whole % p10 + p10 ).substr( 1 );
+         std::string result = ( negative ? "-" : "" ) + std::to_string( whole / p10 );
+         if( p > 0 ) {
+            result += "." + fraction;
+         }
+         return result + " " + symbol.code().to_string();
+      }
+   };
+
+}
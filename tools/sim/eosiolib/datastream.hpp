@@ -0,0 +1,273 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "asset.hpp"
+
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace eosio {
+
+   template<typename T>
+   class datastream {
+      public:
+         datastream( T start, size_t s ) : _start( start ), _pos( start ), _end( start + s ) {}
+
+         inline void skip( size_t s ) { _pos += s; }
+
+         inline bool read( char* d, size_t s ) {
+            eosio_assert( size_t( _end - _pos ) >= s, "read" );
+            memcpy( d, _pos, s );
+            _pos += s;
+            return true;
+         }
+
+         inline bool write( const char* d, size_t s ) {
+            eosio_assert( size_t( _end - _pos ) >= s, "write" );
+            memcpy( (void*)_pos, d, s );
+            _pos += s;
+            return true;
+         }
+
+         inline bool put( char c ) {
+            eosio_assert( _pos < _end, "put" );
+            *_pos = c;
+            ++_pos;
+            return true;
+         }
+
+         inline bool get( char& c ) {
+            eosio_assert( _pos < _end, "get" );
+            c = *_pos;
+            ++_pos;
+            return true;
+         }
+
+         T pos() const { return _pos; }
+         inline bool valid() const { return _pos <= _end && _pos >= _start; }
+         inline bool seekp( size_t p ) { _pos = _start + p; return _pos <= _end; }
+         inline size_t tellp() const { return size_t( _pos - _start ); }
+         inline size_t remaining() const { return _end - _pos; }
+
+      private:
+         T _start;
+         T _pos;
+         T _end;
+   };
+
+   //counts the bytes a value packs to
+   template<>
+   class datastream<size_t> {
+      public:
+         datastream( size_t init_size = 0 ) : _size( init_size ) {}
+
+         inline bool skip( size_t s ) { _size += s; return true; }
+         inline bool write( const char*, size_t s ) { _size += s; return true; }
+         inline bool put( char ) { _size++; return true; }
+         inline bool valid() const { return true; }
+         inline bool seekp( size_t p ) { _size = p; return true; }
+         inline size_t tellp() const { return _size; }
+         inline size_t remaining() const { return 0; }
+
+      private:
+         size_t _size;
+   };
+
+   struct unsigned_int {
+      unsigned_int( uint32_t v = 0 ) : value( v ) {}
+      operator uint32_t() const { return value; }
+      uint32_t value;
+   };
+
+   template<typename Stream>
+   datastream<Stream>& operator<<( datastream<Stream>& ds, const unsigned_int& v ) {
+      uint64_t val = v.value;
+      do {
+         uint8_t b = uint8_t( val ) & 0x7f;
+         val >>= 7;
+         b |= ( ( val > 0 ) << 7 );
+         ds.put( b );
+      } while( val );
+      return ds;
+   }
+
+   template<typename Stream>
+   datastream<Stream>& operator>>( datastream<Stream>& ds, unsigned_int& vi ) {
+      uint64_t v = 0;
+      char b = 0;
+      uint8_t by = 0;
+      do {
+         ds.get( b );
+         v |= uint32_t( uint8_t( b ) & 0x7f ) << by;
+         by += 7;
+      } while( uint8_t( b ) & 0x80 && by < 35 );
+      vi.value = static_cast<uint32_t>( v );
+      return ds;
+   }
+
+   //integers, floats, names and symbols go over the wire as their raw bytes
+   template<typename T>
+   constexpr bool is_raw_v = std::is_arithmetic<T>::value || std::is_same<T, name>::value ||
+                             std::is_same<T, symbol>::value || std::is_same<T, symbol_code>::value ||
+                             std::is_same<T, unsigned __int128>::value || std::is_same<T, __int128>::value;
+
+   template<typename Stream, typename T, std::enable_if_t<is_raw_v<T>>* = nullptr>
+   datastream<Stream>& operator<<( datastream<Stream>& ds, const T& v ) {
+      ds.write( (const char*)&v, sizeof(T) );
+      return ds;
+   }
+
+   template<typename Stream, typename T, std::enable_if_t<is_raw_v<T>>* = nullptr>
+   datastream<Stream>& operator>>( datastream<Stream>& ds, T& v ) {
+      ds.read( (char*)&v, sizeof(T) );
+      return ds;
+   }
+
+   template<typename Stream>
+   datastream<Stream>& operator<<( datastream<Stream>& ds, const asset& v ) {
+      return ds << v.amount << v.symbol;
+   }
+
+   template<typename Stream>
+   datastream<Stream>& operator>>( datastream<Stream>& ds, asset& v ) {
+      return ds >> v.amount >> v.symbol;
+   }
+
+   template<typename Stream>
+   datastream<Stream>& operator<<( datastream<Stream>& ds, const std::string& v ) {
+      ds << unsigned_int( v.size() );
+      if( v.size() ) {
+         ds.write( v.data(), v.size() );
+      }
+      return ds;
+   }
+
+   template<typename Stream>
+   datastream<Stream>& operator>>( datastream<Stream>& ds, std::string& v ) {
+      unsigned_int s;
+      ds >> s;
+      v.resize( s.value );
+      if( s.value ) {
+         ds.read( v.data(), s.value );
+      }
+      return ds;
+   }
+
+   template<typename Stream, typename T>
+   datastream<Stream>& operator<<( datastream<Stream>& ds, const std::vector<T>& v ) {
+      ds << unsigned_int( v.size() );
+      for( const auto& i : v ) {
+         ds << i;
+      }
+      return ds;
+   }
+
+   template<typename Stream, typename T>
+   datastream<Stream>& operator>>( datastream<Stream>& ds, std::vector<T>& v ) {
+      unsigned_int s;
+      ds >> s;
+      v.resize( s.value );
+      for( auto& i : v ) {
+         ds >> i;
+      }
+      return ds;
+   }
+
+   template<typename Stream, typename... Args>
+   datastream<Stream>& operator<<( datastream<Stream>& ds, const std::tuple<Args...>& t ) {
+      std::apply( [&]( const auto&... e ) { ( ( ds << e ), ... ); }, t );
+      return ds;
+   }
+
+   template<typename Stream, typename... Args>
+   datastream<Stream>& operator>>( datastream<Stream>& ds, std::tuple<Args...>& t ) {
+      std::apply( [&]( auto&... e ) { ( ( ds >> e ), ... ); }, t );
+      return ds;
+   }
+
+   //eosio.cdt packs a struct without EOSLIB_SERIALIZE field by field through boost::pfr. The
+   //table and action structs here are aggregates, so their fields are reached the same way
+   //with structured bindings, once their count is known
+   namespace reflect {
+      struct any_field {
+         template<typename T>
+         operator T() const;
+      };
+
+      template<typename T, typename... Fields>
+      constexpr size_t field_count( long ) {
+         return sizeof...(Fields) - 1;
+      }
+
+      template<typename T, typename... Fields>
+      constexpr auto field_count( int ) -> decltype( T{ Fields{}... }, size_t() ) {
+         return field_count<T, Fields..., any_field>( 0 );
+      }
+
+      template<typename T, typename F>
+      void for_each_field( T& t, F&& f ) {
+         constexpr size_t n = field_count<std::remove_const_t<T>>( 0 );
+         static_assert( n <= 10, "structs of more than 10 fields aren't supported" );
+         if constexpr( n == 1 ) { auto& [a] = t; f( a ); }
+         else if constexpr( n == 2 ) { auto& [a, b] = t; f( a ); f( b ); }
+         else if constexpr( n == 3 ) { auto& [a, b, c] = t; f( a ); f( b ); f( c ); }
+         else if constexpr( n == 4 ) { auto& [a, b, c, d] = t; f( a ); f( b ); f( c ); f( d ); }
+         else if constexpr( n == 5 ) { auto& [a, b, c, d, e] = t; f( a ); f( b ); f( c ); f( d ); f( e ); }
+         else if constexpr( n == 6 ) { auto& [a, b, c, d, e, g] = t; f( a ); f( b ); f( c ); f( d ); f( e ); f( g ); }
+         else if constexpr( n == 7 ) { auto& [a, b, c, d, e, g, h] = t; f( a ); f( b ); f( c ); f( d ); f( e ); f( g ); f( h ); }
+         else if constexpr( n == 8 ) { auto& [a, b, c, d, e, g, h, i] = t; f( a ); f( b ); f( c ); f( d ); f( e ); f( g ); f( h ); f( i ); }
+         else if constexpr( n == 9 ) { auto& [a, b, c, d, e, g, h, i, j] = t; f( a ); f( b ); f( c ); f( d ); f( e ); f( g ); f( h ); f( i ); f( j ); }
+         else if constexpr( n == 10 ) { auto& [a, b, c, d, e, g, h, i, j, k] = t; f( a ); f( b ); f( c ); f( d ); f( e ); f( g ); f( h ); f( i ); f( j ); f( k ); }
+      }
+
+      template<typename T>
+      constexpr bool is_reflected_v = std::is_class<T>::value && std::is_aggregate<T>::value;
+   }
+
+   template<typename Stream, typename T, std::enable_if_t<reflect::is_reflected_v<T>>* = nullptr>
+   datastream<Stream>& operator<<( datastream<Stream>& ds, const T& v ) {
+      reflect::for_each_field( v, [&]( const auto& field ) { ds << field; } );
+      return ds;
+   }
+
+   template<typename Stream, typename T, std::enable_if_t<reflect::is_reflected_v<T>>* = nullptr>
+   datastream<Stream>& operator>>( datastream<Stream>& ds, T& v ) {
+      reflect::for_each_field( v, [&]( auto& field ) { ds >> field; } );
+      return ds;
+   }
+
+   template<typename T>
+   size_t pack_size( const T& value ) {
+      datastream<size_t> ps;
+      ps << value;
+      return ps.tellp();
+   }
+
+   template<typename T>
+   std::vector<char> pack( const T& value ) {
+      std::vector<char> result( pack_size( value ) );
+      datastream<char*> ds( result.data(), result.size() );
+      ds << value;
+      return result;
+   }
+
+   template<typename T>
+   T unpack( const char* buffer, size_t len ) {
+      T result{};
+      datastream<const char*> ds( buffer, len );
+      ds >> result;
+      return result;
+   }
+
+   template<typename T>
+   T unpack( const std::vector<char>& bytes ) {
+      return unpack<T>( bytes.data(), bytes.size() );
+   }
+
+}
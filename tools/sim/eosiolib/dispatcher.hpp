@@ -0,0 +1,50 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "contract.hpp"
+#include "../chain.hpp"
+
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+namespace eosio {
+
+   //unpacks the action data into the member's arguments and calls it on a fresh contract object
+   template<typename T, typename... Args>
+   bool execute_action( name self, name code, void ( T::*func )( Args... ) ) {
+      size_t size = action_data_size();
+      std::vector<char> buffer( size );
+      read_action_data( buffer.data(), size );
+
+      std::tuple<std::decay_t<Args>...> args;
+      datastream<const char*> ds( buffer.data(), size );
+      ds >> args;
+
+      T inst( self, code, ds );
+      std::apply( [&]( auto&... a ) { ( ( &inst )->*func )( a... ); }, args );
+      return true;
+   }
+
+}
+
+#define EOSIO_DISPATCH_INTERNAL( r, OP, elem ) \
+   case eosio::name( BOOST_PP_STRINGIZE( elem ) ).value: \
+      eosio::execute_action( eosio::name( receiver ), eosio::name( code ), &OP::elem ); \
+      break;
+
+#define EOSIO_DISPATCH_HELPER( TYPE, MEMBERS ) \
+   BOOST_PP_SEQ_FOR_EACH( EOSIO_DISPATCH_INTERNAL, TYPE, MEMBERS )
+
+#define EOSIO_DISPATCH( TYPE, MEMBERS ) \
+   extern "C" { \
+      void apply( uint64_t receiver, uint64_t code, uint64_t action ) { \
+         if( code == receiver ) { \
+            switch( action ) { \
+               EOSIO_DISPATCH_HELPER( TYPE, MEMBERS ) \
+            } \
+         } \
+      } \
+   }
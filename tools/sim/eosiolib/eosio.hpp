@@ -0,0 +1,13 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "action.hpp"
+#include "contract.hpp"
+#include "dispatcher.hpp"
+#include "multi_index.hpp"
+#include "print.hpp"
+
+#include <cmath>
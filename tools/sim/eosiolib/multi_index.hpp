@@ -0,0 +1,473 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "datastream.hpp"
+#include "../chain.hpp"
+
+#include <array>
+#include <iterator>
+#include <limits>
+#include <memory>
+
+//multi_index over the simulator's packed rows. It keeps eosio.cdt's caching, so a row is
+//unpacked once per table object and modify and get hand back the cached object, and it counts
+//the database calls the node's version would make for the same operations
+namespace eosio {
+
+   constexpr static inline name same_payer{};
+
+   template<name::raw IndexName, typename Extractor>
+   struct indexed_by {
+      static constexpr uint64_t index_name = static_cast<uint64_t>( IndexName );
+      typedef Extractor secondary_extractor_type;
+   };
+
+   template<class Class, typename Type, Type ( Class::*PtrToMemberFunction )() const>
+   struct const_mem_fun {
+      typedef typename std::remove_reference<Type>::type result_type;
+
+      Type operator()( const Class& x ) const { return ( x.*PtrToMemberFunction )(); }
+   };
+
+   template<name::raw TableName, typename T, typename... Indices>
+   class multi_index {
+      private:
+         static_assert( sizeof...(Indices) <= 16, "multi_index only supports a maximum of 16 secondary indices" );
+
+         static constexpr uint64_t no_available_primary_key = std::numeric_limits<uint64_t>::max() - 1;
+
+         //a secondary index is stored as the table name with the index's position in the low 4 bits
+         static constexpr uint64_t index_table( size_t n ) {
+            return ( static_cast<uint64_t>( TableName ) & 0xFFFFFFFFFFFFFFF0ULL ) | ( n & 0x0F );
+         }
+
+         template<name::raw IndexName, size_t N = 0>
+         static constexpr size_t index_position() {
+            if constexpr( N == sizeof...(Indices) ) {
+               static_assert( N < sizeof...(Indices), "name provided is not the name of any secondary index within multi_index" );
+               return N;
+            } else if constexpr( std::tuple_element_t<N, std::tuple<Indices...>>::index_name == static_cast<uint64_t>( IndexName ) ) {
+               return N;
+            } else {
+               return index_position<IndexName, N + 1>();
+            }
+         }
+
+         typedef std::array<uint64_t, sizeof...(Indices)> secondary_keys;
+
+      public:
+         class const_iterator {
+            public:
+               typedef std::bidirectional_iterator_tag iterator_category;
+               typedef const T value_type;
+               typedef std::ptrdiff_t difference_type;
+               typedef const T* pointer;
+               typedef const T& reference;
+
+               const_iterator() = default;
+
+               const T& operator*() const {
+                  eosio_assert( _item != nullptr, "cannot dereference end iterator" );
+                  return *_item;
+               }
+               const T* operator->() const { return &**this; }
+
+               const_iterator& operator++() {
+                  eosio_assert( _item != nullptr, "cannot increment end iterator" );
+                  _item = _multidx->next( *_item );
+                  return *this;
+               }
+
+               const_iterator& operator--() {
+                  _item = _multidx->previous( _item );
+                  return *this;
+               }
+
+               const_iterator operator++( int ) {
+                  const_iterator result( *this );
+                  ++( *this );
+                  return result;
+               }
+
+               const_iterator operator--( int ) {
+                  const_iterator result( *this );
+                  --( *this );
+                  return result;
+               }
+
+               friend bool operator==( const const_iterator& a, const const_iterator& b ) { return a._item == b._item; }
+               friend bool operator!=( const const_iterator& a, const const_iterator& b ) { return a._item != b._item; }
+
+            private:
+               friend class multi_index;
+
+               const_iterator( const multi_index* mi, const T* i = nullptr ) : _multidx( mi ), _item( i ) {}
+
+               const multi_index* _multidx = nullptr;
+               const T* _item = nullptr;
+         };
+
+         typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+         template<name::raw IndexName, typename Extractor, uint64_t Number>
+         class index {
+            public:
+               typedef typename std::decay<decltype( Extractor()( std::declval<const T&>() ) )>::type secondary_key_type;
+               static_assert( std::is_same<secondary_key_type, uint64_t>::value, "the simulator only keeps 64 bit secondary keys" );
+
+               class const_iterator {
+                  public:
+                     typedef std::bidirectional_iterator_tag iterator_category;
+                     typedef const T value_type;
+                     typedef std::ptrdiff_t difference_type;
+                     typedef const T* pointer;
+                     typedef const T& reference;
+
+                     const_iterator() = default;
+
+                     const T& operator*() const {
+                        eosio_assert( _item != nullptr, "cannot dereference end iterator" );
+                        return *_item;
+                     }
+                     const T* operator->() const { return &**this; }
+
+                     const_iterator& operator++() {
+                        eosio_assert( _item != nullptr, "cannot increment end iterator" );
+                        _item = _idx->next( *_item );
+                        return *this;
+                     }
+
+                     const_iterator& operator--() {
+                        _item = _idx->previous( _item );
+                        return *this;
+                     }
+
+                     const_iterator operator++( int ) {
+                        const_iterator result( *this );
+                        ++( *this );
+                        return result;
+                     }
+
+                     const_iterator operator--( int ) {
+                        const_iterator result( *this );
+                        --( *this );
+                        return result;
+                     }
+
+                     friend bool operator==( const const_iterator& a, const const_iterator& b ) { return a._item == b._item; }
+                     friend bool operator!=( const const_iterator& a, const const_iterator& b ) { return a._item != b._item; }
+
+                  private:
+                     friend class index;
+
+                     const_iterator( const index* idx, const T* i = nullptr ) : _idx( idx ), _item( i ) {}
+
+                     const index* _idx = nullptr;
+                     const T* _item = nullptr;
+               };
+
+               typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+               const_iterator begin() const { return lower_bound( std::numeric_limits<uint64_t>::lowest() ); }
+               const_iterator end() const { return const_iterator( this ); }
+               const_reverse_iterator rbegin() const { return const_reverse_iterator( end() ); }
+               const_reverse_iterator rend() const { return const_reverse_iterator( begin() ); }
+
+               const_iterator lower_bound( uint64_t secondary ) const {
+                  sim::chain().costs.db_ops++;
+                  return at( keys().lower_bound( { secondary, 0 } ) );
+               }
+
+               const_iterator upper_bound( uint64_t secondary ) const {
+                  sim::chain().costs.db_ops++;
+                  return at( keys().upper_bound( { secondary, std::numeric_limits<uint64_t>::max() } ) );
+               }
+
+               const_iterator find( uint64_t secondary ) const {
+                  auto itr = lower_bound( secondary );
+                  if( itr == end() || Extractor()( *itr ) != secondary ) {
+                     return end();
+                  }
+                  return itr;
+               }
+
+               const T& get( uint64_t secondary, const char* error_msg = "unable to find secondary key" ) const {
+                  auto result = find( secondary );
+                  eosio_assert( result != end(), error_msg );
+                  return *result;
+               }
+
+               const_iterator iterator_to( const T& obj ) const {
+                  _multidx->check_cached( obj );
+                  return const_iterator( this, &obj );
+               }
+
+               template<typename Lambda>
+               void modify( const_iterator itr, eosio::name payer, Lambda&& updater ) {
+                  eosio_assert( itr != end(), "cannot pass end iterator to modify" );
+                  _multidx->modify( *itr, payer, std::forward<Lambda&&>( updater ) );
+               }
+
+               const_iterator erase( const_iterator itr ) {
+                  eosio_assert( itr != end(), "cannot pass end iterator to erase" );
+                  const T& obj = *itr;
+                  ++itr;
+                  _multidx->erase( obj );
+                  return itr;
+               }
+
+               eosio::name get_code() const { return _multidx->get_code(); }
+               uint64_t get_scope() const { return _multidx->get_scope(); }
+
+            private:
+               friend class multi_index;
+
+               explicit index( multi_index* midx ) : _multidx( midx ) {}
+
+               const sim::index_keys& keys() const { return sim::chain().db.indices[_multidx->index_id( Number )]; }
+
+               const_iterator at( sim::index_keys::const_iterator itr ) const {
+                  return const_iterator( this, itr == keys().end() ? nullptr : _multidx->find_object( itr->second ) );
+               }
+
+               const T* next( const T& obj ) const {
+                  sim::chain().costs.db_ops++;
+                  return at( keys().upper_bound( { Extractor()( obj ), obj.primary_key() } ) )._item;
+               }
+
+               const T* previous( const T* obj ) const {
+                  sim::chain().costs.db_ops++;
+                  auto& k = keys();
+                  auto itr = obj == nullptr ? k.end() : k.lower_bound( { Extractor()( *obj ), obj->primary_key() } );
+                  eosio_assert( itr != k.begin(), "cannot decrement iterator at beginning of index" );
+                  return at( --itr )._item;
+               }
+
+               multi_index* _multidx;
+         };
+
+         multi_index( name code, uint64_t scope ) : _code( code ), _scope( scope ) {}
+
+         multi_index( const multi_index& ) = delete;
+         multi_index& operator=( const multi_index& ) = delete;
+
+         name get_code() const { return _code; }
+         uint64_t get_scope() const { return _scope; }
+
+         const_iterator begin() const { return lower_bound( std::numeric_limits<uint64_t>::lowest() ); }
+         const_iterator end() const { return const_iterator( this ); }
+         const_reverse_iterator rbegin() const { return const_reverse_iterator( end() ); }
+         const_reverse_iterator rend() const { return const_reverse_iterator( begin() ); }
+
+         const_iterator lower_bound( uint64_t primary ) const {
+            sim::chain().costs.db_ops++;
+            auto rows = sim::chain().db.find( id() );
+            if( rows == nullptr ) {
+               return end();
+            }
+            auto itr = rows->lower_bound( primary );
+            return const_iterator( this, itr == rows->end() ? nullptr : load( itr->first ) );
+         }
+
+         const_iterator upper_bound( uint64_t primary ) const {
+            sim::chain().costs.db_ops++;
+            auto rows = sim::chain().db.find( id() );
+            if( rows == nullptr ) {
+               return end();
+            }
+            auto itr = rows->upper_bound( primary );
+            return const_iterator( this, itr == rows->end() ? nullptr : load( itr->first ) );
+         }
+
+         uint64_t available_primary_key() const {
+            if( !_next_primary_key_known ) {
+               //db_end_i64 and db_previous_i64
+               sim::chain().costs.db_ops += 2;
+               auto rows = sim::chain().db.find( id() );
+               _next_primary_key = rows == nullptr || rows->empty() ? 0 : rows->rbegin()->first + 1;
+               _next_primary_key_known = true;
+            }
+            eosio_assert( _next_primary_key < no_available_primary_key, "next primary key in table is at autoincrement limit" );
+            return _next_primary_key;
+         }
+
+         template<name::raw IndexName>
+         auto get_index() const {
+            constexpr size_t n = index_position<IndexName>();
+            typedef typename std::tuple_element_t<n, std::tuple<Indices...>>::secondary_extractor_type extractor;
+            return index<IndexName, extractor, n>( const_cast<multi_index*>( this ) );
+         }
+
+         const_iterator iterator_to( const T& obj ) const {
+            check_cached( obj );
+            return const_iterator( this, &obj );
+         }
+
+         template<typename Lambda>
+         const_iterator emplace( name payer, Lambda&& constructor ) {
+            eosio_assert( _code.value == current_receiver(), "cannot create objects in table of another contract" );
+            auto obj = std::make_unique<T>();
+            constructor( *obj );
+            uint64_t pk = obj->primary_key();
+
+            auto& rows = sim::chain().db.tables[id()];
+            eosio_assert( rows.count( pk ) == 0, "could not insert object, most likely a uniqueness constraint was violated" );
+            write( rows[pk], *obj );
+            auto keys = secondaries( *obj );
+            for( size_t n = 0; n < keys.size(); n++ ) {
+               sim::chain().costs.db_ops++;
+               sim::chain().db.indices[index_id( n )].emplace( keys[n], pk );
+            }
+            if( _next_primary_key_known && pk >= _next_primary_key ) {
+               _next_primary_key = pk >= no_available_primary_key ? no_available_primary_key : pk + 1;
+            }
+
+            const T* item = obj.get();
+            _items[pk] = std::move( obj );
+            return const_iterator( this, item );
+         }
+
+         template<typename Lambda>
+         void modify( const_iterator itr, name payer, Lambda&& updater ) {
+            eosio_assert( itr != end(), "cannot pass end iterator to modify" );
+            modify( *itr, payer, std::forward<Lambda&&>( updater ) );
+         }
+
+         template<typename Lambda>
+         void modify( const T& obj, name payer, Lambda&& updater ) {
+            eosio_assert( _code.value == current_receiver(), "cannot modify objects in table of another contract" );
+            check_cached( obj );
+            T& mutable_obj = const_cast<T&>( obj );
+            uint64_t pk = obj.primary_key();
+            auto before = secondaries( obj );
+
+            updater( mutable_obj );
+            eosio_assert( pk == mutable_obj.primary_key(), "updater cannot change primary key when modifying an object" );
+
+            write( sim::chain().db.tables[id()][pk], mutable_obj );
+            auto after = secondaries( mutable_obj );
+            for( size_t n = 0; n < after.size(); n++ ) {
+               //db_idx64_find_primary, then db_idx64_update if the key moved
+               sim::chain().costs.db_ops++;
+               if( before[n] != after[n] ) {
+                  sim::chain().costs.db_ops++;
+                  auto& keys = sim::chain().db.indices[index_id( n )];
+                  keys.erase( { before[n], pk } );
+                  keys.emplace( after[n], pk );
+               }
+            }
+         }
+
+         const T& get( uint64_t primary, const char* error_msg = "unable to find key" ) const {
+            auto result = find( primary );
+            eosio_assert( result != end(), error_msg );
+            return *result;
+         }
+
+         const_iterator find( uint64_t primary ) const { return const_iterator( this, find_object( primary ) ); }
+
+         const_iterator require_find( uint64_t primary, const char* error_msg = "unable to find key" ) const {
+            auto result = find( primary );
+            eosio_assert( result != end(), error_msg );
+            return result;
+         }
+
+         const_iterator erase( const_iterator itr ) {
+            eosio_assert( itr != end(), "cannot pass end iterator to erase" );
+            const T& obj = *itr;
+            ++itr;
+            erase( obj );
+            return itr;
+         }
+
+         void erase( const T& obj ) {
+            eosio_assert( _code.value == current_receiver(), "cannot erase objects in table of another contract" );
+            check_cached( obj );
+            uint64_t pk = obj.primary_key();
+            auto keys = secondaries( obj );
+            for( size_t n = 0; n < keys.size(); n++ ) {
+               //db_idx64_find_primary and db_idx64_remove
+               sim::chain().costs.db_ops += 2;
+               sim::chain().db.indices[index_id( n )].erase( { keys[n], pk } );
+            }
+            sim::chain().costs.db_ops++;
+            sim::chain().costs.writes++;
+            sim::chain().db.tables[id()].erase( pk );
+            sim::chain().db.drop_if_empty( id() );
+            _items.erase( pk );
+         }
+
+      private:
+         sim::table_id id() const { return { _code.value, _scope, static_cast<uint64_t>( TableName ) }; }
+         sim::table_id index_id( size_t n ) const { return { _code.value, _scope, index_table( n ) }; }
+
+         static secondary_keys secondaries( const T& obj ) {
+            return { { uint64_t( typename Indices::secondary_extractor_type()( obj ) )... } };
+         }
+
+         static void write( std::vector<char>& row, const T& obj ) {
+            row = pack( obj );
+            sim::chain().costs.db_ops++;
+            sim::chain().costs.writes++;
+            sim::chain().costs.bytes_written += row.size();
+         }
+
+         void check_cached( const T& obj ) const {
+            auto itr = _items.find( obj.primary_key() );
+            eosio_assert( itr != _items.end() && itr->second.get() == &obj, "object passed is not in multi_index" );
+         }
+
+         //the cached object of a row known to exist, unpacked by db_get_i64 on first use
+         const T* load( uint64_t primary ) const {
+            auto itr = _items.find( primary );
+            if( itr != _items.end() ) {
+               return itr->second.get();
+            }
+            sim::chain().costs.db_ops++;
+            const auto& row = sim::chain().db.find( id() )->at( primary );
+            auto obj = std::make_unique<T>( unpack<T>( row ) );
+            const T* item = obj.get();
+            _items[primary] = std::move( obj );
+            return item;
+         }
+
+         //the cache first, then db_find_i64
+         const T* find_object( uint64_t primary ) const {
+            if( _items.count( primary ) ) {
+               return _items.at( primary ).get();
+            }
+            sim::chain().costs.db_ops++;
+            auto rows = sim::chain().db.find( id() );
+            if( rows == nullptr || rows->count( primary ) == 0 ) {
+               return nullptr;
+            }
+            return load( primary );
+         }
+
+         const T* next( const T& obj ) const {
+            sim::chain().costs.db_ops++;
+            auto rows = sim::chain().db.find( id() );
+            auto itr = rows == nullptr ? decltype( rows->end() )() : rows->upper_bound( obj.primary_key() );
+            return rows == nullptr || itr == rows->end() ? nullptr : load( itr->first );
+         }
+
+         const T* previous( const T* obj ) const {
+            sim::chain().costs.db_ops++;
+            auto rows = sim::chain().db.find( id() );
+            eosio_assert( rows != nullptr, "cannot decrement end iterator when the table is empty" );
+            auto itr = obj == nullptr ? rows->end() : rows->lower_bound( obj->primary_key() );
+            eosio_assert( itr != rows->begin(), "cannot decrement iterator at beginning of table" );
+            return load( ( --itr )->first );
+         }
+
+         name _code;
+         uint64_t _scope;
+         mutable bool _next_primary_key_known = false;
+         mutable uint64_t _next_primary_key = 0;
+         mutable std::map<uint64_t, std::unique_ptr<T>> _items;
+   };
+
+}
@@ -0,0 +1,31 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "asset.hpp"
+#include "../chain.hpp"
+
+#include <type_traits>
+
+//prints go to the console of the action, as a node would keep them
+namespace eosio {
+
+   inline void print( const char* s ) { sim::chain().console += s; }
+   inline void print( const std::string& s ) { sim::chain().console += s; }
+   inline void print( name n ) { sim::chain().console += n.to_string(); }
+   inline void print( const asset& a ) { sim::chain().console += a.to_string(); }
+
+   template<typename T, std::enable_if_t<std::is_arithmetic<T>::value>* = nullptr>
+   void print( T v ) {
+      sim::chain().console += std::to_string( v );
+   }
+
+   template<typename Arg, typename Next, typename... Args>
+   void print( Arg&& a, Next&& b, Args&&... rest ) {
+      print( std::forward<Arg>( a ) );
+      print( std::forward<Next>( b ), std::forward<Args>( rest )... );
+   }
+
+}
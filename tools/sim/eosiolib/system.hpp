@@ -0,0 +1,28 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace eosio {
+
+   //a failed assertion aborts the action on a node; in the simulator it unwinds to the tester,
+   //which rolls the tables back
+   struct assert_failure : std::runtime_error {
+      using std::runtime_error::runtime_error;
+   };
+
+   inline void check( bool pred, const char* msg ) {
+      if( !pred ) {
+         throw assert_failure( msg );
+      }
+   }
+
+}
+
+inline void eosio_assert( uint32_t test, const char* msg ) {
+   eosio::check( test != 0, msg );
+}
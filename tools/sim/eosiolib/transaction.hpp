@@ -0,0 +1,28 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "action.hpp"
+
+namespace eosio {
+
+   struct transaction {
+      uint32_t delay_sec = 0;
+      std::vector<action> actions;
+
+      //deferred transactions are recorded, and run only if a test pushes them itself
+      void send( const unsigned __int128& sender_id, name payer, bool replace_existing = false ) const {
+         for( const auto& a : actions ) {
+            sim::chain().costs.deferred++;
+            sim::chain().deferred.push_back( a.sent() );
+         }
+      }
+   };
+
+   inline int cancel_deferred( const unsigned __int128& sender_id ) {
+      return 0;
+   }
+
+}
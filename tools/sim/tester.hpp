@@ -0,0 +1,107 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "eosiolib/action.hpp"
+
+extern "C" void apply( uint64_t receiver, uint64_t code, uint64_t action );
+
+namespace eosio { namespace sim {
+
+   //an action as the contract ran it, in the order a node would run them, and what it cost
+   struct applied_action {
+      uint32_t time;
+      name code;
+      name action;
+      std::vector<char> data;
+      action_costs costs;
+   };
+
+   //pushes transactions of one action at the contract linked into the test
+   class tester {
+      public:
+         explicit tester( name contract ) : contract( contract ) { chain() = chain_state(); }
+
+         //runs the action with the given authorizations, then the inline actions it sent to the
+         //contract. A failed assertion anywhere rolls the tables back and is rethrown, as the
+         //node would fail the transaction. The costs are those of the pushed action alone
+         template<typename... Args>
+         action_costs push( name action, std::vector<name> auths, const Args&... args ) {
+            return push_packed( contract, action, std::move( auths ), pack( std::make_tuple( args... ) ) );
+         }
+
+         //an action on another contract that notifies this one, such as a bounty top up
+         template<typename... Args>
+         action_costs notify( name code, name action, const Args&... args ) {
+            return push_packed( code, action, {}, pack( std::make_tuple( args... ) ) );
+         }
+
+         action_costs push_packed( name code, name action, std::vector<name> auths, std::vector<char> data ) {
+            database saved = chain().db;
+            size_t applied_size = applied.size();
+            try {
+               return run( code, action, auths, data );
+            } catch( ... ) {
+               chain().db = std::move( saved );
+               applied.resize( applied_size );
+               throw;
+            }
+         }
+
+         //the assertion message a push fails with, or an empty string if it succeeds
+         template<typename... Args>
+         std::string push_error( name action, std::vector<name> auths, const Args&... args ) {
+            try {
+               push( action, std::move( auths ), args... );
+            } catch( const assert_failure& e ) {
+               return e.what();
+            }
+            return std::string();
+         }
+
+         template<typename... Args>
+         std::string notify_error( name code, name action, const Args&... args ) {
+            try {
+               notify( code, action, args... );
+            } catch( const assert_failure& e ) {
+               return e.what();
+            }
+            return std::string();
+         }
+
+         void advance( uint32_t seconds ) { chain().now += seconds; }
+
+         name contract;
+         std::vector<applied_action> applied;
+
+      private:
+         action_costs run( name code, name action, const std::vector<name>& auths, const std::vector<char>& data ) {
+            auto& c = chain();
+            c.receiver = contract;
+            c.auths.clear();
+            for( auto a : auths ) {
+               c.auths.insert( a.value );
+            }
+            c.action_data = data;
+            c.costs = action_costs();
+            c.inline_actions.clear();
+            size_t index = applied.size();
+            applied.push_back( applied_action{ c.now, code, action, data, {} } );
+
+            ::apply( contract.value, code.value, action.value );
+
+            action_costs costs = c.costs;
+            applied[index].costs = costs;
+            auto sent = std::move( c.inline_actions );
+            for( const auto& s : sent ) {
+               if( s.account == contract ) {
+                  run( contract, s.action, s.actors, s.data );
+               }
+            }
+            return costs;
+         }
+   };
+
+} }
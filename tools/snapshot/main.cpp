@@ -0,0 +1,265 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "snapshot.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+using namespace dconnect;
+
+static void usage() {
+   fprintf( stderr,
+            "usage: dconnect-snapshot export --store FILE --out FILE [--contract NAME]\n"
+            "       dconnect-snapshot restore --snapshot FILE --store FILE [--fresh]\n"
+            "       dconnect-snapshot actions --snapshot FILE [--contract NAME] [--chunk BYTES] [--cleos CMD]\n"
+            "       dconnect-snapshot info --snapshot FILE\n" );
+   exit( 2 );
+}
+
+struct file_closer {
+   void operator()( FILE* f ) const { fclose( f ); }
+};
+typedef std::unique_ptr<FILE, file_closer> file_ptr;
+
+static file_ptr open_file( const std::string& path, const char* mode ) {
+   file_ptr f( fopen( path.c_str(), mode ) );
+   if( !f ) {
+      throw std::runtime_error( "cannot open " + path );
+   }
+   return f;
+}
+
+static void read_exact( FILE* f, void* data, size_t size ) {
+   if( fread( data, 1, size, f ) != size ) {
+      throw std::runtime_error( "snapshot is truncated" );
+   }
+}
+
+static snapshot_header read_header( FILE* f ) {
+   snapshot_header h;
+   read_exact( f, &h, sizeof(h) );
+   if( memcmp( h.magic, snapshot_magic, sizeof(snapshot_magic) ) != 0 || h.version != snapshot_version ) {
+      throw std::runtime_error( "not a snapshot of this version" );
+   }
+   return h;
+}
+
+static section_header read_section( FILE* f ) {
+   section_header s;
+   read_exact( f, &s, sizeof(s) );
+   if( s.row_size != row_size( s.table ) ) {
+      throw std::runtime_error( "rows of " + dconnect::name( s.table ).to_string() + " have the wrong size" );
+   }
+   return s;
+}
+
+//sorts an index of the store's rows and writes them straight from the mapped file,
+//so memory use is the index rather than the rows
+static void export_snapshot( const std::string& store_path, const std::string& out_path, dconnect::name contract ) {
+   struct stat st;
+   if( ::stat( store_path.c_str(), &st ) != 0 ) {
+      throw std::runtime_error( "no store at " + store_path );
+   }
+   store db( store_path, 0 );
+   struct entry {
+      uint64_t table;
+      uint64_t scope;
+      uint64_t key;
+      const slot* row;
+   };
+   std::vector<entry> rows;
+   rows.reserve( db.used() );
+   db.for_each( [&]( const slot& s ) {
+      entry e{ 0, 0, 0, &s };
+      if( row_of( s, contract, e.table, e.scope, e.key ) ) {
+         rows.push_back( e );
+      }
+   });
+   std::sort( rows.begin(), rows.end(), []( const entry& a, const entry& b ) {
+      return std::tie( a.table, a.scope, a.key ) < std::tie( b.table, b.scope, b.key );
+   });
+
+   auto f = open_file( out_path, "wb" );
+   snapshot_header h{};
+   memcpy( h.magic, snapshot_magic, sizeof(snapshot_magic) );
+   h.version = snapshot_version;
+   h.tables = std::size( snapshot_tables );
+   h.contract = contract.value;
+   h.offset = db.offset();
+   h.records = db.records();
+   h.queues = db.meta();
+   h.queues.used = 0;
+   fwrite( &h, sizeof(h), 1, f.get() );
+
+   writer w;
+   for( uint64_t table : snapshot_tables ) {
+      auto begin = std::lower_bound( rows.begin(), rows.end(), table, []( const entry& e, uint64_t t ) { return e.table < t; } );
+      auto end = std::upper_bound( begin, rows.end(), table, []( uint64_t t, const entry& e ) { return t < e.table; } );
+      section_header s{ table, row_size( table ), 0, uint64_t( end - begin ) };
+      fwrite( &s, sizeof(s), 1, f.get() );
+      for( auto itr = begin; itr != end; ++itr ) {
+         w.bytes.clear();
+         w.write( itr->scope );
+         pack_row( *itr->row, w );
+         fwrite( w.bytes.data(), 1, w.bytes.size(), f.get() );
+      }
+   }
+   if( fflush( f.get() ) != 0 ) {
+      throw std::runtime_error( "cannot write " + out_path );
+   }
+   printf( "exported %zu rows\n", rows.size() );
+}
+
+//fresh starts the store at the beginning of a trace file instead of where the snapshot's store
+//was, for a deployment whose traces begin after the snapshot's rows were imported
+static void restore_snapshot( const std::string& path, const std::string& store_path, bool fresh ) {
+   struct stat st;
+   if( ::stat( store_path.c_str(), &st ) == 0 ) {
+      throw std::runtime_error( store_path + " already exists" );
+   }
+   auto f = open_file( path, "rb" );
+   auto h = read_header( f.get() );
+
+   //sections are read twice, once to size the store
+   uint64_t total = 0;
+   long start = ftell( f.get() );
+   for( uint32_t i = 0; i < h.tables; i++ ) {
+      auto s = read_section( f.get() );
+      total += s.rows;
+      fseek( f.get(), s.rows * ( 8 + s.row_size ), SEEK_CUR );
+   }
+   fseek( f.get(), start, SEEK_SET );
+   uint64_t capacity = 1024;
+   while( capacity < total * 2 ) {
+      capacity *= 2;
+   }
+
+   store db( store_path, capacity );
+   uint64_t used = db.meta().used;
+   db.meta() = h.queues;
+   db.meta().used = used;
+   state state( db, dconnect::name( h.contract ) );
+   std::vector<char> row;
+   for( uint32_t i = 0; i < h.tables; i++ ) {
+      auto s = read_section( f.get() );
+      row.resize( 8 + s.row_size );
+      for( uint64_t n = 0; n < s.rows; n++ ) {
+         read_exact( f.get(), row.data(), row.size() );
+         uint64_t scope;
+         memcpy( &scope, row.data(), sizeof(scope) );
+         state.import_row( s.table, scope, row.data() + 8, s.row_size );
+      }
+   }
+   uint64_t offset = fresh ? 0 : h.offset;
+   db.commit( offset, fresh ? 0 : h.records );
+   printf( "restored %llu rows, the indexer resumes at offset %llu\n", (unsigned long long)total,
+           (unsigned long long)offset );
+}
+
+//prints one importrows action per chunk, each chunk holding whole rows of one table
+static void print_actions( const std::string& path, const std::string& contract, size_t chunk, const std::string& cleos ) {
+   auto f = open_file( path, "rb" );
+   auto h = read_header( f.get() );
+   std::string account = contract.empty() ? dconnect::name( h.contract ).to_string() : contract;
+   static const char* hex = "0123456789abcdef";
+   std::vector<char> rows;
+   auto flush = [&]( uint64_t table ) {
+      if( rows.empty() ) {
+         return;
+      }
+      std::string data;
+      data.reserve( rows.size() * 2 );
+      for( char c : rows ) {
+         data += hex[uint8_t( c ) >> 4];
+         data += hex[uint8_t( c ) & 0xf];
+      }
+      printf( "%s push action %s importrows '[\"%s\", \"%s\"]' -p %s@active\n", cleos.c_str(), account.c_str(),
+              dconnect::name( table ).to_string().c_str(), data.c_str(), account.c_str() );
+      rows.clear();
+   };
+   for( uint32_t i = 0; i < h.tables; i++ ) {
+      auto s = read_section( f.get() );
+      size_t size = 8 + s.row_size;
+      for( uint64_t n = 0; n < s.rows; n++ ) {
+         if( rows.size() + size > chunk ) {
+            flush( s.table );
+         }
+         rows.resize( rows.size() + size );
+         char* row = rows.data() + rows.size() - size;
+         read_exact( f.get(), row, size );
+         uint64_t scope;
+         memcpy( &scope, row, sizeof(scope) );
+         scope = import_scope( s.table, scope, dconnect::name( account ) );
+         memcpy( row, &scope, sizeof(scope) );
+      }
+      flush( s.table );
+   }
+}
+
+static void print_info( const std::string& path ) {
+   auto f = open_file( path, "rb" );
+   auto h = read_header( f.get() );
+   printf( "contract %s, %llu trace records up to offset %llu\n", dconnect::name( h.contract ).to_string().c_str(),
+           (unsigned long long)h.records, (unsigned long long)h.offset );
+   printf( "rewards [%llu, %llu) payouts [%llu, %llu)\n", (unsigned long long)h.queues.reward_head,
+           (unsigned long long)h.queues.reward_tail, (unsigned long long)h.queues.payout_head,
+           (unsigned long long)h.queues.payout_tail );
+   for( uint32_t i = 0; i < h.tables; i++ ) {
+      auto s = read_section( f.get() );
+      printf( "%-10s %llu rows\n", dconnect::name( s.table ).to_string().c_str(), (unsigned long long)s.rows );
+      fseek( f.get(), s.rows * ( 8 + s.row_size ), SEEK_CUR );
+   }
+}
+
+int main( int argc, char** argv ) {
+   if( argc < 2 ) {
+      usage();
+   }
+   std::string command = argv[1];
+   std::string store_path, snapshot_path, out_path, contract, cleos = "cleos";
+   size_t chunk = 32768;
+   bool fresh = false;
+   for( int i = 2; i < argc; i++ ) {
+      std::string arg = argv[i];
+      if( arg == "--fresh" ) {
+         fresh = true;
+         continue;
+      }
+      if( i + 1 == argc ) {
+         usage();
+      }
+      const char* value = argv[++i];
+      if( arg == "--store" ) store_path = value;
+      else if( arg == "--snapshot" ) snapshot_path = value;
+      else if( arg == "--out" ) out_path = value;
+      else if( arg == "--contract" ) contract = value;
+      else if( arg == "--chunk" ) chunk = strtoull( value, nullptr, 10 );
+      else if( arg == "--cleos" ) cleos = value;
+      else usage();
+   }
+
+   try {
+      if( command == "export" && !store_path.empty() && !out_path.empty() ) {
+         export_snapshot( store_path, out_path, dconnect::name( contract.empty() ? "dconnect" : contract ) );
+      } else if( command == "restore" && !snapshot_path.empty() && !store_path.empty() ) {
+         restore_snapshot( snapshot_path, store_path, fresh );
+      } else if( command == "actions" && !snapshot_path.empty() && chunk >= 84 ) {
+         print_actions( snapshot_path, contract, chunk, cleos );
+      } else if( command == "info" && !snapshot_path.empty() ) {
+         print_info( snapshot_path );
+      } else {
+         usage();
+      }
+   } catch( const std::exception& e ) {
+      fprintf( stderr, "%s\n", e.what() );
+      return 1;
+   }
+   return 0;
+}
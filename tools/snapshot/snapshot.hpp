@@ -0,0 +1,106 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "../indexer/state.hpp"
+
+#include <cstdio>
+
+//a snapshot holds the contract's tables as sections of rows in their on-chain encoding, each
+//row after its scope and sorted by scope then primary key, which is what importrows takes
+namespace dconnect {
+
+   struct snapshot_header {
+      char magic[8];
+      uint32_t version;
+      uint32_t tables;
+      uint64_t contract;
+      uint64_t offset;        //trace file offset of the indexer store it was taken from
+      uint64_t records;
+      region_header queues;   //queue keys and policy, for restoring into a store
+   };
+
+   //every row of a table packs to the same size, so a section is rows * ( 8 + row_size ) bytes
+   struct section_header {
+      uint64_t table;
+      uint32_t row_size;
+      uint32_t reserved;
+      uint64_t rows;
+   };
+
+   constexpr char snapshot_magic[8] = { 'd', 'c', 's', 'n', 'a', 'p', 0, 0 };
+   constexpr uint32_t snapshot_version = 1;
+
+   //stat first, since importing a queue row looks up its token
+   constexpr uint64_t snapshot_tables[] = { tables::stat, tables::accounts, tables::totals,
+                                            tables::contents, tables::payouts };
+
+   //the table, scope and primary key a store slot is exported under, false if it isn't exported
+   inline bool row_of( const slot& s, dconnect::name contract, uint64_t& table, uint64_t& scope, uint64_t& key ) {
+      switch( s.kind ) {
+         case kind::stat: table = tables::stat; scope = s.k1; key = s.k1; return true;
+         case kind::balance: table = tables::accounts; scope = s.k1; key = s.k2; return true;
+         case kind::user_total: table = tables::totals; scope = s.k1; key = s.k2; return true;
+         case kind::content_total: table = tables::contents; scope = contract.value; key = s.k1; return true;
+         case kind::payout: table = tables::payouts; scope = tables::payouts; key = s.k2; return true;
+         case kind::reward: table = tables::payouts; scope = tables::rewards; key = s.k2; return true;
+         default: return false;
+      }
+   }
+
+   //the scope a snapshot row is imported under. Contents rows are scoped by the contract itself,
+   //so they move to the account the snapshot is imported into
+   inline uint64_t import_scope( uint64_t table, uint64_t scope, dconnect::name target ) {
+      return table == tables::contents ? target.value : scope;
+   }
+
+   //packs a store slot as the contract's row
+   inline void pack_row( const slot& s, writer& w ) {
+      switch( s.kind ) {
+         case kind::stat: {
+            auto& st = *reinterpret_cast<const stat_row*>( s.payload );
+            w.write_asset( st.supply );
+            w.write_asset( st.max_supply );
+            w.write_name( st.issuer );
+            w.write_name( st.bounty_contract );
+            w.write_asset( st.bounty );
+            w.write( st.lastpay );
+            w.write( st.bounty_rate );
+            break;
+         }
+         case kind::balance:
+            w.write_asset( reinterpret_cast<const balance_row*>( s.payload )->balance );
+            break;
+         case kind::user_total:
+         case kind::content_total: {
+            auto& t = *reinterpret_cast<const total_row*>( s.payload );
+            w.write( s.kind == kind::user_total ? s.k2 : s.k1 );
+            w.write_name( t.name );
+            w.write( t.time );
+            w.write_asset( t.quantity );
+            w.write( t.content );
+            w.write( t.hot );
+            break;
+         }
+         case kind::payout:
+         case kind::reward: {
+            //rewards leave bounty empty, payouts vote and content, as the contract does
+            auto& q = *reinterpret_cast<const queue_row*>( s.payload );
+            w.write( s.k2 );
+            w.write_asset( q.bounty );
+            w.write_name( q.to );
+            w.write( uint64_t( 0 ) );
+            w.write( q.time );
+            w.write_asset( q.quantity );
+            w.write_name( q.vote );
+            w.write( q.content );
+            break;
+         }
+         default:
+            break;
+      }
+   }
+
+}
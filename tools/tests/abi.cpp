@@ -0,0 +1,189 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "scenario.hpp"
+
+#include <common/json.hpp>
+#include <common/serialize.hpp>
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace dconnect::test;
+
+//the checked in abi against the contract: every action it runs and every row it leaves behind
+//has to decode with the abi's types, byte for byte, or a client reading them through the abi
+//would go wrong. A table or action added without its abi entry fails here
+namespace {
+
+   struct abi_field {
+      std::string name;
+      std::string type;
+   };
+
+   struct abi_struct {
+      std::string base;
+      std::vector<abi_field> fields;
+   };
+
+   struct abi_table {
+      std::string type;
+      size_t indices = 0;
+   };
+
+   struct abi_def {
+      std::map<std::string, abi_struct> structs;
+      std::map<std::string, std::string> types;
+      std::map<std::string, std::string> actions;
+      std::map<uint64_t, abi_table> tables;
+
+      //reads one value of the type, throwing if the type is unknown or the bytes run out
+      void decode( const std::string& type, dconnect::reader& r ) const {
+         if( type.size() > 2 && type.compare( type.size() - 2, 2, "[]" ) == 0 ) {
+            std::string item = type.substr( 0, type.size() - 2 );
+            for( uint32_t n = r.read_varuint32(); n > 0; n-- ) {
+               decode( item, r );
+            }
+         } else if( type == "bool" || type == "int8" || type == "uint8" ) {
+            r.read<uint8_t>();
+         } else if( type == "int32" || type == "uint32" ) {
+            r.read<uint32_t>();
+         } else if( type == "int64" || type == "uint64" || type == "name" || type == "symbol" || type == "symbol_code" ) {
+            r.read<uint64_t>();
+         } else if( type == "asset" ) {
+            r.read_asset();
+         } else if( type == "string" || type == "bytes" ) {
+            r.read_string();
+         } else if( types.count( type ) ) {
+            decode( types.at( type ), r );
+         } else if( structs.count( type ) ) {
+            const auto& s = structs.at( type );
+            if( !s.base.empty() ) {
+               decode( s.base, r );
+            }
+            for( const auto& f : s.fields ) {
+               decode( f.type, r );
+            }
+         } else {
+            throw dconnect::decode_error( "abi has no type " + type );
+         }
+      }
+
+      //whether the bytes are exactly one value of the type
+      bool decodes( const std::string& type, const std::vector<char>& data ) const {
+         dconnect::reader r( data.data(), data.size() );
+         try {
+            decode( type, r );
+         } catch( const dconnect::decode_error& e ) {
+            fprintf( stderr, "%s: %s\n", type.c_str(), e.what() );
+            return false;
+         }
+         return r.remaining() == 0;
+      }
+   };
+
+   abi_def load_abi( const char* path ) {
+      std::ifstream in( path );
+      std::stringstream text;
+      text << in.rdbuf();
+      auto doc = dconnect::parse_json( text.str() );
+
+      abi_def abi;
+      for( const auto& s : doc["structs"].items ) {
+         auto& def = abi.structs[s["name"].text];
+         def.base = s["base"].text;
+         for( const auto& f : s["fields"].items ) {
+            def.fields.push_back( abi_field{ f["name"].text, f["type"].text } );
+         }
+      }
+      for( const auto& t : doc["types"].items ) {
+         abi.types[t["new_type_name"].text] = t["type"].text;
+      }
+      for( const auto& a : doc["actions"].items ) {
+         abi.actions[a["name"].text] = a["type"].text;
+      }
+      for( const auto& t : doc["tables"].items ) {
+         abi.tables[name( t["name"].text ).value] = abi_table{ t["type"].text, t["key_names"].items.size() };
+      }
+      return abi;
+   }
+
+   //every row of the contract's tables, and every secondary index, as the abi describes them
+   void check_tables( const abi_def& abi, const std::string& step ) {
+      const auto& db = eosio::sim::chain().db;
+      for( const auto& t : db.tables ) {
+         if( t.first.code != contract.value ) {
+            continue;
+         }
+         auto table = abi.tables.find( t.first.table );
+         if( table == abi.tables.end() ) {
+            fprintf( stderr, "after %s: table %s is not in the abi\n", step.c_str(), name( t.first.table ).to_string().c_str() );
+            failures()++;
+            continue;
+         }
+         for( const auto& row : t.second ) {
+            EXPECT( abi.decodes( table->second.type, row.second ) );
+         }
+      }
+      for( const auto& i : db.indices ) {
+         if( i.first.code != contract.value || i.second.empty() ) {
+            continue;
+         }
+         auto table = abi.tables.find( i.first.table & 0xFFFFFFFFFFFFFFF0ULL );
+         EXPECT( table != abi.tables.end() && table->second.indices > ( i.first.table & 0x0F ) );
+      }
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   if( argc != 2 ) {
+      fprintf( stderr, "usage: %s ABI\n", argv[0] );
+      return 2;
+   }
+   abi_def abi = load_abi( argv[1] );
+   EXPECT( !abi.actions.empty() && !abi.tables.empty() );
+
+   tester t( contract );
+   run_scenario( t, [&]( const std::string& step, const action_costs& ) {
+      check_tables( abi, step );
+   });
+
+   //the contract's own actions, the inline log actions among them
+   std::set<std::string> ran;
+   for( const auto& a : t.applied ) {
+      if( a.code != contract ) {
+         continue;
+      }
+      std::string action = a.action.to_string();
+      ran.insert( action );
+      auto type = abi.actions.find( action );
+      if( type == abi.actions.end() ) {
+         fprintf( stderr, "action %s is not in the abi\n", action.c_str() );
+         failures()++;
+      } else {
+         EXPECT( abi.decodes( type->second, a.data ) );
+      }
+   }
+
+   //the scenario can't run setconfig on a build with a fixed policy, so every abi action is
+   //also pushed with no data and no authority, which only an action the contract dispatches
+   //rejects with an assertion rather than ignoring
+   for( const auto& a : abi.actions ) {
+      bool dispatched = false;
+      try {
+         t.push_packed( contract, name( a.first ), {}, {} );
+      } catch( const eosio::assert_failure& ) {
+         dispatched = true;
+      }
+      if( !dispatched && ran.count( a.first ) == 0 ) {
+         fprintf( stderr, "abi action %s is not dispatched\n", a.first.c_str() );
+         failures()++;
+      }
+   }
+
+   return finish( "abi" );
+}
@@ -0,0 +1,165 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "scenario.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace dconnect::test;
+
+//the commitment row has to agree with the accounts rows it summarizes
+static void check_commitment( const std::vector<name>& owners ) {
+   eosio::token::commitment_state c;
+   EXPECT( read_row( name( "commitment" ), dcn.code().raw(), name( "commitment" ).value, c ) );
+   int64_t held = 0;
+   uint64_t holders = 0, digest = 0;
+   for( auto owner : owners ) {
+      asset balance;
+      if( read_row( name( "accounts" ), owner.value, dcn.code().raw(), balance ) ) {
+         held += balance.amount;
+         holders += balance.amount != 0;
+         digest += eosio::balance_mix( owner.value, balance.amount );
+      }
+   }
+   EXPECT_EQ( c.held.amount, held );
+   EXPECT_EQ( c.holders, holders );
+   EXPECT_EQ( c.digest, digest );
+   EXPECT_EQ( c.held, eosio::token::get_supply( contract, dcn.code() ) );
+}
+
+//a token upgraded in place: its balances predate the commitment row, which balance changes then
+//build from zero. A backfill in two pages, with balances changing between them, has to end with
+//the row every other test expects
+static void check_backfill() {
+   tester t( contract );
+   const name alice( "alice" ), bob( "bob" ), carol( "carol" );
+   create_token( t, 10000000 );
+   t.push( name( "transfer" ), { issuer }, issuer, alice, dcn_amount( 1000000 ), std::string() );
+   t.push( name( "transfer" ), { issuer }, issuer, bob, dcn_amount( 2000000 ), std::string() );
+   t.push( name( "transfer" ), { issuer }, issuer, carol, dcn_amount( 3000000 ), std::string() );
+
+   eosio::sim::chain().db.tables.erase( { contract.value, dcn.code().raw(), name( "commitment" ).value } );
+   t.push( name( "transfer" ), { alice }, alice, bob, dcn_amount( 1000 ), std::string() );
+   eosio::token::commitment_state c;
+   EXPECT( read_row( name( "commitment" ), dcn.code().raw(), name( "commitment" ).value, c ) );
+   EXPECT( c.held.amount == 0 && c.holders == 0 );
+
+   std::vector<name> owners = { issuer, alice, bob, carol };
+   std::sort( owners.begin(), owners.end(), []( name a, name b ) { return a.value < b.value; } );
+   std::vector<name> first( owners.begin(), owners.begin() + 2 ), rest( owners.begin() + 2, owners.end() );
+
+   EXPECT_EQ( t.push_error( name( "backfill" ), { alice }, dcn.code(), first, false ), "missing authority of " + contract.to_string() );
+   t.push( name( "backfill" ), { contract }, dcn.code(), first, false );
+   EXPECT( read_row( name( "commitment" ), dcn.code().raw(), name( "commitment" ).value, c ) );
+   EXPECT_EQ( c.counted_to, first.back().value + 1 );
+
+   //between counted owners, between owners still to come, and across the two
+   for( size_t i = 0; i + 1 < owners.size(); i++ ) {
+      t.push( name( "transfer" ), { owners[i] }, owners[i], owners[i + 1], dcn_amount( 100 + i ), std::string() );
+      t.push( name( "transfer" ), { owners[i + 1] }, owners[i + 1], owners[i], dcn_amount( 10 + i ), std::string() );
+   }
+   EXPECT_EQ( t.push_error( name( "backfill" ), { contract }, dcn.code(), first, true ), "owners must be ascending and not yet counted" );
+   t.push( name( "backfill" ), { contract }, dcn.code(), rest, true );
+   EXPECT( read_row( name( "commitment" ), dcn.code().raw(), name( "commitment" ).value, c ) );
+   EXPECT_EQ( c.counted_to, std::numeric_limits<uint64_t>::max() );
+   check_commitment( owners );
+
+   t.push( name( "transfer" ), { bob }, bob, alice, dcn_amount( 5 ), std::string() );
+   check_commitment( owners );
+}
+
+//a transfer from the bounty contract has to name a token that takes its bounty from there,
+//while one from any other contract is accepted without a credit whatever its memo
+static void check_bounty_top_up() {
+   tester t( contract );
+   const name funder( "funder" ), other( "othertoken" );
+   create_token( t, 10000000 );
+   auto bounty_of = [&]() {
+      eosio::token::currency_stats st;
+      read_row( name( "stat" ), dcn.code().raw(), dcn.code().raw(), st );
+      return st.bounty.amount;
+   };
+
+   t.notify( bounty, name( "transfer" ), funder, contract, bnt_amount( 1000 ), std::string( "DCN" ) );
+   EXPECT_EQ( bounty_of(), 1000 );
+   EXPECT_EQ( t.notify_error( bounty, name( "transfer" ), funder, contract, bnt_amount( 1000 ), std::string( "DCNDCNDC" ) ),
+              "bounty memo must be a token symbol" );
+   EXPECT_EQ( t.notify_error( bounty, name( "transfer" ), funder, contract, bnt_amount( 1000 ), std::string( "dcn" ) ),
+              "bounty memo must be a token symbol" );
+   EXPECT_EQ( t.notify_error( bounty, name( "transfer" ), funder, contract, bnt_amount( 1000 ), std::string( "XYZ" ) ),
+              "bounty memo names an unknown token" );
+   EXPECT_EQ( bounty_of(), 1000 );
+
+   EXPECT_EQ( t.notify_error( other, name( "transfer" ), funder, contract, bnt_amount( 1000 ), std::string( "thanks" ) ), "" );
+   EXPECT_EQ( t.notify_error( other, name( "transfer" ), funder, contract, bnt_amount( 1000 ), std::string( "DCN" ) ), "" );
+   EXPECT_EQ( bounty_of(), 1000 );
+}
+
+//held leaves out what sits in the reward queue: a reward takes its quantity out of the sender's
+//balance, and settlement pays it back out together with what it mints
+static void check_supply_equation() {
+   tester t( contract );
+   //the imported token only adds up once its queue rows are in too
+   bool imported = false;
+   run_scenario( t, [&]( const std::string& step, const action_costs& ) {
+      eosio::token::metrics_state m;
+      read_row( name( "metrics" ), contract.value, name( "metrics" ).value, m );
+      imported = imported || step == "import payouts";
+      for( auto code : { dcn.code(), old.code() } ) {
+         eosio::token::commitment_state c;
+         if( code == old.code() && !imported ) {
+            continue;
+         }
+         if( !read_row( name( "commitment" ), code.raw(), name( "commitment" ).value, c ) ) {
+            continue;
+         }
+         int64_t pending = 0;
+         for( const auto& q : m.queues ) {
+            pending += q.sym == code ? q.pending_rewards.amount : 0;
+         }
+         int64_t supply = eosio::token::get_supply( contract, code ).amount;
+         if( c.held.amount != supply - pending ) {
+            fprintf( stderr, "after %s: held %lld, supply %lld, pending rewards %lld\n", step.c_str(), (long long)c.held.amount,
+                     (long long)supply, (long long)pending );
+            failures()++;
+         }
+      }
+   });
+}
+
+int main() {
+   tester t( contract );
+   const name alice( "alice" ), bob( "bob" ), carol( "carol" );
+   create_token( t, 10000000 );
+
+   t.push( name( "transfer" ), { issuer }, issuer, alice, dcn_amount( 1000000 ), std::string() );
+   EXPECT_EQ( eosio::token::get_balance( contract, alice, dcn.code() ).amount, 1000000 );
+   check_commitment( { issuer, alice, bob, carol } );
+
+   //an overdrawn transfer fails without touching either balance or the commitment
+   EXPECT_EQ( t.push_error( name( "transfer" ), { alice }, alice, bob, dcn_amount( 1000001 ), std::string() ), "overdrawn balance" );
+   EXPECT_EQ( eosio::token::get_balance( contract, alice, dcn.code() ).amount, 1000000 );
+   EXPECT( eosio::sim::chain().db.find( { contract.value, bob.value, name( "accounts" ).value } ) == nullptr );
+
+   //an owner without a row can't send, and doesn't get one made for it
+   EXPECT_EQ( t.push_error( name( "transfer" ), { carol }, carol, bob, dcn_amount( 1 ), std::string() ), "no balance object found" );
+   EXPECT( eosio::sim::chain().db.find( { contract.value, carol.value, name( "accounts" ).value } ) == nullptr );
+
+   //sending the whole balance leaves a zero row, which no longer counts as a holder
+   t.push( name( "transfer" ), { alice }, alice, bob, dcn_amount( 1000000 ), std::string() );
+   EXPECT_EQ( eosio::token::get_balance( contract, alice, dcn.code() ).amount, 0 );
+   EXPECT_EQ( eosio::token::get_balance( contract, bob, dcn.code() ).amount, 1000000 );
+   check_commitment( { issuer, alice, bob, carol } );
+
+   t.push( name( "close" ), { alice }, alice, dcn );
+   EXPECT( eosio::sim::chain().db.find( { contract.value, alice.value, name( "accounts" ).value } ) == nullptr );
+   check_commitment( { issuer, alice, bob, carol } );
+
+   check_backfill();
+   check_supply_equation();
+   check_bounty_top_up();
+   return finish( "balances" );
+}
@@ -0,0 +1,126 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "scenario.hpp"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace dconnect::test;
+
+//what every action of the scenario costs, inline actions included, against the baseline checked
+//in next to this file. Any count that goes up fails the test. A change that brings counts down,
+//or one that has to raise them and says why, rewrites the baseline with --write
+namespace {
+
+   const char* header = "#db_ops writes bytes_written inline_actions deferred step / action";
+
+   //one line per action, labelled with the scenario step that ran it
+   typedef std::vector<std::pair<std::string, action_costs>> cost_lines;
+
+   cost_lines measure() {
+      tester t( contract );
+      cost_lines lines;
+      size_t seen = 0;
+      run_scenario( t, [&]( const std::string& step, const action_costs& ) {
+         for( ; seen < t.applied.size(); seen++ ) {
+            const auto& a = t.applied[seen];
+            std::string label = step + " / " + ( a.code == contract ? "" : a.code.to_string() + "::" ) + a.action.to_string();
+            lines.emplace_back( label, a.costs );
+         }
+      });
+      return lines;
+   }
+
+   std::string format( const action_costs& c ) {
+      char line[128];
+      snprintf( line, sizeof(line), "%llu %llu %llu %llu %llu", (unsigned long long)c.db_ops, (unsigned long long)c.writes,
+                (unsigned long long)c.bytes_written, (unsigned long long)c.inline_actions, (unsigned long long)c.deferred );
+      return line;
+   }
+
+   bool read_baseline( const char* path, cost_lines& lines ) {
+      std::ifstream in( path );
+      if( !in ) {
+         return false;
+      }
+      std::string line;
+      while( std::getline( in, line ) ) {
+         if( line.empty() || line[0] == '#' ) {
+            continue;
+         }
+         std::istringstream fields( line );
+         action_costs c;
+         fields >> c.db_ops >> c.writes >> c.bytes_written >> c.inline_actions >> c.deferred;
+         std::string label;
+         std::getline( fields >> std::ws, label );
+         lines.emplace_back( label, c );
+      }
+      return true;
+   }
+
+   void write_baseline( const char* path, const cost_lines& lines ) {
+      std::ofstream out( path );
+      out << header << "\n";
+      for( const auto& l : lines ) {
+         out << format( l.second ) << " " << l.first << "\n";
+      }
+   }
+
+   void compare( const std::string& label, const char* what, uint64_t base, uint64_t now ) {
+      if( now > base ) {
+         fprintf( stderr, "%s: %s went up from %llu to %llu\n", label.c_str(), what, (unsigned long long)base, (unsigned long long)now );
+         failures()++;
+      } else if( now < base ) {
+         printf( "%s: %s went down from %llu to %llu, rewrite the baseline with --write\n", label.c_str(), what,
+                 (unsigned long long)base, (unsigned long long)now );
+      }
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   bool write = argc == 3 && std::string( argv[1] ) == "--write";
+   if( argc != 2 && !write ) {
+      fprintf( stderr, "usage: %s [--write] BASELINE\n", argv[0] );
+      return 2;
+   }
+   const char* path = argv[argc - 1];
+   cost_lines now = measure();
+   if( write ) {
+      write_baseline( path, now );
+      printf( "wrote %zu actions to %s\n", now.size(), path );
+      return 0;
+   }
+
+   cost_lines base;
+   if( !read_baseline( path, base ) ) {
+      fprintf( stderr, "cannot read %s\n", path );
+      return 1;
+   }
+   //the scenario's actions are compared in order, so one added or removed shows up as a mismatch
+   if( base.size() != now.size() ) {
+      fprintf( stderr, "the baseline has %zu actions and the scenario ran %zu, rewrite it with --write\n", base.size(), now.size() );
+      failures()++;
+   }
+   for( size_t i = 0; i < base.size() && i < now.size(); i++ ) {
+      const auto& label = now[i].first;
+      if( base[i].first != label ) {
+         fprintf( stderr, "action %zu is %s in the baseline but %s now\n", i, base[i].first.c_str(), label.c_str() );
+         failures()++;
+         continue;
+      }
+      const auto& b = base[i].second;
+      const auto& c = now[i].second;
+      compare( label, "db_ops", b.db_ops, c.db_ops );
+      compare( label, "writes", b.writes, c.writes );
+      compare( label, "bytes_written", b.bytes_written, c.bytes_written );
+      compare( label, "inline_actions", b.inline_actions, c.inline_actions );
+      compare( label, "deferred", b.deferred, c.deferred );
+   }
+
+   return finish( "costs" );
+}
@@ -0,0 +1,84 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "fixture.hpp"
+
+using namespace dconnect::test;
+
+//built with DCONNECT_RAW_DISPATCH: transfer, reward and retire decode their own action data,
+//so payloads that are too large, cut short, padded or carry a memo over the limit have to fail
+//before anything is written
+namespace {
+
+   std::string packed_error( tester& t, name action, std::vector<name> auths, const std::vector<char>& data ) {
+      try {
+         t.push_packed( contract, action, std::move( auths ), data );
+      } catch( const eosio::assert_failure& e ) {
+         return e.what();
+      }
+      return std::string();
+   }
+
+   template<typename... Args>
+   std::vector<char> packed( const Args&... args ) {
+      return eosio::pack( std::make_tuple( args... ) );
+   }
+
+}
+
+int main() {
+   tester t( contract );
+   const name alice( "alice" ), bob( "bob" );
+   create_token( t, 10000000 );
+   t.push( name( "transfer" ), { issuer }, issuer, alice, dcn_amount( 1000000 ), std::string() );
+   auto balance = [&]( name owner ) { return eosio::token::get_balance( contract, owner, dcn.code() ).amount; };
+
+   //the largest valid payload, a reward with a memo at the limit, goes through
+   std::string at_limit( eosio::policy::memo_limit(), 'm' );
+   auto reward = packed( alice, bob, dcn_amount( 1000 ), at_limit, int64_t( 1 ) );
+   t.push_packed( contract, name( "reward" ), { alice }, reward );
+   EXPECT_EQ( balance( alice ), 1000000 - 1000 );
+
+   //oversized: over the 512 byte buffer, whatever it holds
+   auto oversized = packed( alice, bob, dcn_amount( 1000 ), std::string( 600, 'm' ), int64_t( 1 ) );
+   EXPECT_EQ( packed_error( t, name( "reward" ), { alice }, oversized ), "action data too large" );
+   std::vector<char> padded = reward;
+   padded.resize( 513 );
+   EXPECT_EQ( packed_error( t, name( "reward" ), { alice }, padded ), "action data too large" );
+
+   //a memo one byte over the limit, which still fits the buffer
+   auto over_limit = packed( alice, bob, dcn_amount( 1000 ), at_limit + "m", int64_t( 1 ) );
+   EXPECT( over_limit.size() <= 512 );
+   EXPECT_EQ( packed_error( t, name( "reward" ), { alice }, over_limit ), "memo is too long" );
+   EXPECT_EQ( packed_error( t, name( "transfer" ), { alice }, packed( alice, bob, dcn_amount( 1 ), at_limit + "m" ) ), "memo is too long" );
+   EXPECT_EQ( packed_error( t, name( "retire" ), { alice }, packed( alice, dcn_amount( 1 ), at_limit + "m" ) ), "memo is too long" );
+
+   //truncated: every prefix of each action's data, cut inside a name, an asset, the memo's
+   //length, the memo or the content id
+   const std::pair<name, std::vector<char>> actions[] = {
+      { name( "transfer" ), packed( alice, bob, dcn_amount( 1 ), std::string( "a memo" ) ) },
+      { name( "reward" ), packed( alice, bob, dcn_amount( 1000 ), std::string( 200, 'm' ), int64_t( 1 ) ) },
+      { name( "retire" ), packed( alice, dcn_amount( 1 ), std::string( "a memo" ) ) },
+   };
+   for( const auto& a : actions ) {
+      for( size_t size = 0; size < a.second.size(); size++ ) {
+         std::vector<char> cut( a.second.begin(), a.second.begin() + size );
+         std::string error = packed_error( t, a.first, { alice }, cut );
+         if( error != "read past end of action data" ) {
+            fprintf( stderr, "%s cut to %zu bytes: %s\n", a.first.to_string().c_str(), size, error.c_str() );
+            failures()++;
+         }
+      }
+      //and one byte too many
+      std::vector<char> trailing = a.second;
+      trailing.push_back( 0 );
+      EXPECT_EQ( packed_error( t, a.first, { alice }, trailing ), "unexpected trailing action data" );
+   }
+
+   //none of it touched a balance or queued anything
+   EXPECT_EQ( balance( alice ), 1000000 - 1000 );
+   EXPECT_EQ( eosio::token::get_queued( contract, name( "rewards" ), alice, dcn ).amount, 1000 );
+   return finish( "dispatch" );
+}
@@ -0,0 +1,102 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "scenario.hpp"
+
+#include "../indexer/state.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+
+using namespace dconnect::test;
+
+//the scenario's traces through dconnect-export and back out with --dump, against the events
+//the indexer's state emits for the same traces. Small chunks put the boundary inside the
+//history, and alice and bob appear in several chunks, so each chunk's dictionaries start over.
+//The imported queue keys sit far above the scenario's own, so the key deltas go negative
+namespace {
+
+   std::string output_of( const std::string& command, int& status ) {
+      FILE* p = popen( command.c_str(), "r" );
+      std::string out;
+      char buffer[4096];
+      size_t n;
+      while( ( n = fread( buffer, 1, sizeof(buffer), p ) ) > 0 ) {
+         out.append( buffer, n );
+      }
+      status = pclose( p );
+      return out;
+   }
+
+   //the csv --dump prints, from the events of the indexer's state
+   std::string expected_csv( const std::string& traces, const std::string& store_path ) {
+      std::string csv = "type,key,time,to,vote,quantity,quantity_symbol,amount,amount_symbol,content\n";
+      static const char* names[] = { "reward", "retire", "payout", "settle" };
+      dconnect::store db( store_path, 1024 );
+      auto& m = db.meta();
+      m.lock_period = eosio::policy::lock_period();
+      m.payout_rate = eosio::policy::payout_rate();
+      m.vote_rate = eosio::policy::vote_rate();
+      m.rate_base = eosio::policy::rate_base();
+      dconnect::state st( db, dconnect::name( contract.value ) );
+      st.on_event = [&]( const dconnect::event& e ) {
+         char line[512];
+         snprintf( line, sizeof(line), "%s,%llu,%u,%s,%s,%lld,%s,%lld,%s,%llu\n", names[e.type], (unsigned long long)e.key,
+                   e.time, e.to.to_string().c_str(), e.vote.to_string().c_str(), (long long)e.quantity.amount,
+                   e.quantity.symbol.code_string().c_str(), (long long)e.amount.amount, e.amount.symbol.code_string().c_str(),
+                   (unsigned long long)e.content );
+         csv += line;
+      };
+      dconnect::trace_file file( traces );
+      uint64_t offset = 0;
+      while( auto t = file.at( offset ) ) {
+         st.apply( *t );
+         offset = t->end;
+      }
+      return csv;
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   if( argc != 2 ) {
+      fprintf( stderr, "usage: %s EXPORT\n", argv[0] );
+      return 2;
+   }
+   std::string exporter = argv[1];
+   std::string prefix = "test-export-" + std::to_string( getpid() );
+   std::string traces = prefix + ".traces", out = prefix + ".cols", store = prefix + ".db";
+
+   {
+      tester t( contract );
+      run_scenario( t, []( const std::string&, const action_costs& ) {} );
+      write_traces( traces, t.applied );
+   }
+   std::string expected = expected_csv( traces, store );
+   ::unlink( store.c_str() );
+   size_t events = std::count( expected.begin(), expected.end(), '\n' ) - 1;
+   EXPECT( events > 8 );
+
+   for( uint32_t chunk_rows : { 4u, 65536u } ) {
+      int status;
+      std::string exported = output_of( exporter + " --traces " + traces + " --out " + out + " --contract " + contract.to_string() +
+                                        " --chunk-rows " + std::to_string( chunk_rows ), status );
+      EXPECT_EQ( status, 0 );
+      uint64_t chunks = ( events + chunk_rows - 1 ) / chunk_rows;
+      EXPECT_EQ( exported, "exported " + std::to_string( events ) + " events in " + std::to_string( chunks ) + " chunks\n" );
+      std::string dumped = output_of( exporter + " --dump " + out, status );
+      EXPECT_EQ( status, 0 );
+      if( dumped != expected ) {
+         fprintf( stderr, "dump with %u rows per chunk:\n%s\nexpected:\n%s", chunk_rows, dumped.c_str(), expected.c_str() );
+         failures()++;
+      }
+   }
+
+   for( const auto& path : { traces, out } ) {
+      ::unlink( path.c_str() );
+   }
+   return finish( "export" );
+}
@@ -0,0 +1,46 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "test.hpp"
+
+#include <sim/tester.hpp>
+#include <dconnect-reward/dconnect-reward.hpp>
+#include <dconnect-reward/commitment.hpp>
+
+//the token the contract tests share: DCN issued by "issuer" with a BNT bounty paid by "bounty"
+namespace dconnect { namespace test {
+
+   using eosio::asset;
+   using eosio::name;
+   using eosio::symbol;
+   using eosio::sim::tester;
+
+   const name contract( "dconnect" );
+   const name issuer( "issuer" );
+   const name bounty( "bounty" );
+   const symbol dcn( "DCN", 4 );
+   const symbol bnt( "BNT", 4 );
+
+   inline asset dcn_amount( int64_t amount ) { return asset( amount, dcn ); }
+   inline asset bnt_amount( int64_t amount ) { return asset( amount, bnt ); }
+
+   //reads a row of the contract's tables straight out of the simulator's database
+   template<typename T>
+   bool read_row( name table, uint64_t scope, uint64_t pk, T& row ) {
+      auto rows = eosio::sim::chain().db.find( { contract.value, scope, table.value } );
+      if( rows == nullptr || rows->count( pk ) == 0 ) {
+         return false;
+      }
+      row = eosio::unpack<T>( rows->at( pk ) );
+      return true;
+   }
+
+   inline void create_token( tester& t, int64_t issued ) {
+      t.push( name( "create" ), { contract }, issuer, dcn_amount( 1000000000000000 ), bounty, bnt_amount( 0 ), uint64_t( 0 ) );
+      t.push( name( "issue" ), { issuer }, issuer, dcn_amount( issued ), std::string( "issued" ) );
+   }
+
+} }
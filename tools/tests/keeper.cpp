@@ -0,0 +1,224 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "test.hpp"
+
+#include "../keeper/keeper.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <vector>
+
+using namespace dconnect;
+using dconnect::test::failures;
+
+//the keeper against a node served on the same event loop. The node answers get_table_rows with
+//a metrics row and the push endpoint holds each crank a while before accepting it, until a set
+//number have been accepted; from then on the queues are empty and cranks are rejected the way
+//nodeos rejects one that finds nothing to settle
+namespace {
+
+   typedef event_loop::clock clock;
+
+   const char* metrics_due =
+      "{\"rows\":[{\"queues\":[{\"sym\":\"DCN\",\"reward_count\":12,\"pending_rewards\":\"1.2000 DCN\",\"settled_rewards\":\"0.0000 DCN\","
+      "\"payout_count\":0,\"pending_payouts\":\"0.0000 DCN\",\"settled_payouts\":\"0.0000 DCN\"}],\"reward_due\":1,\"payout_due\":0,"
+      "\"lastcrank\":0}],\"more\":false,\"next_key\":\"\"}";
+
+   const char* metrics_empty =
+      "{\"rows\":[{\"queues\":[{\"sym\":\"DCN\",\"reward_count\":0,\"pending_rewards\":\"0.0000 DCN\",\"settled_rewards\":\"1.2000 DCN\","
+      "\"payout_count\":0,\"pending_payouts\":\"0.0000 DCN\",\"settled_payouts\":\"0.0000 DCN\"}],\"reward_due\":0,\"payout_due\":0,"
+      "\"lastcrank\":1}],\"more\":false,\"next_key\":\"\"}";
+
+   const char* nothing_to_settle =
+      "{\"code\":500,\"message\":\"Internal Service Error\",\"error\":{\"code\":3050003,\"name\":\"eosio_assert_message_exception\","
+      "\"what\":\"eosio_assert_message assertion failure\",\"details\":[{\"message\":\"assertion failure with message: nothing to settle\","
+      "\"file\":\"cf_system.cpp\",\"line_number\":14,\"method\":\"eosio_assert\"}]}}";
+
+   struct mock_node {
+      event_loop& loop;
+      int listener = -1;
+      std::string url;
+
+      unsigned accept_cranks = 40;
+      milliseconds hold{ 5 };
+
+      unsigned outstanding = 0, peak = 0, accepted = 0, rejected = 0;
+      bool drained = false;
+      std::vector<clock::time_point> empty_polls;
+
+      explicit mock_node( event_loop& loop ) : loop( loop ) {
+         listener = socket( AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+         sockaddr_in addr{};
+         addr.sin_family = AF_INET;
+         addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+         socklen_t size = sizeof(addr);
+         if( bind( listener, reinterpret_cast<sockaddr*>( &addr ), size ) != 0 || listen( listener, 64 ) != 0 ||
+             getsockname( listener, reinterpret_cast<sockaddr*>( &addr ), &size ) != 0 ) {
+            throw std::runtime_error( "cannot listen on the loopback" );
+         }
+         url = "http://127.0.0.1:" + std::to_string( ntohs( addr.sin_port ) );
+      }
+
+      ~mock_node() { ::close( listener ); }
+
+      task<> serve() {
+         while( true ) {
+            co_await loop.readable( listener, clock::now() + std::chrono::hours( 1 ) );
+            int fd;
+            while( ( fd = accept4( listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC ) ) >= 0 ) {
+               spawn( handle( fd ) );
+            }
+         }
+      }
+
+      task<> handle( int fd ) {
+         detail::socket_fd s( fd );
+         auto deadline = clock::now() + std::chrono::seconds( 5 );
+         std::string request;
+         char buffer[4096];
+         size_t body = std::string::npos, length = 0;
+         while( body == std::string::npos || request.size() < body + length ) {
+            ssize_t n = recv( fd, buffer, sizeof(buffer), 0 );
+            if( n > 0 ) {
+               request.append( buffer, n );
+            } else if( n == 0 || ( errno != EAGAIN && errno != EINTR ) || !co_await loop.readable( fd, deadline ) ) {
+               co_return;
+            }
+            if( body == std::string::npos && ( body = request.find( "\r\n\r\n" ) ) != std::string::npos ) {
+               body += 4;
+               auto header = request.find( "Content-Length: " );
+               length = header < body ? strtoull( request.c_str() + header + 16, nullptr, 10 ) : 0;
+            }
+         }
+
+         int status = 200;
+         std::string response;
+         if( request.compare( 0, 30, "POST /v1/chain/get_table_rows " ) == 0 ) {
+            response = drained ? metrics_empty : metrics_due;
+            if( drained ) {
+               empty_polls.push_back( clock::now() );
+            }
+         } else {
+            outstanding++;
+            peak = std::max( peak, outstanding );
+            co_await loop.sleep_for( hold );
+            outstanding--;
+            if( !drained ) {
+               response = "{\"transaction_id\":\"" + std::to_string( accepted ) + "\"}";
+               drained = ++accepted >= accept_cranks;
+            } else {
+               status = 500;
+               response = nothing_to_settle;
+               rejected++;
+            }
+         }
+         std::string raw = "HTTP/1.1 " + std::to_string( status ) + ( status == 200 ? " OK" : " Internal Server Error" ) +
+                           "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string( response.size() ) +
+                           "\r\nConnection: close\r\n\r\n" + response;
+         send( fd, raw.data(), raw.size(), MSG_NOSIGNAL );
+      }
+   };
+
+   //the idle waits, which have to stop short of the next reward or payout coming due
+   void check_idle_wait() {
+      const milliseconds idle( 60000 );
+      queue_summary s;
+      EXPECT( idle_wait( milliseconds( 1000 ), idle, s, 100 ) == milliseconds( 2000 ) );
+      EXPECT( idle_wait( milliseconds( 40000 ), idle, s, 100 ) == idle );
+
+      s.rewards = 1;
+      s.reward_due = 105;
+      EXPECT( idle_wait( milliseconds( 40000 ), idle, s, 100 ) == milliseconds( 5000 ) );
+
+      s.rewards = 0;
+      s.payouts = 1;
+      s.payout_due = 103;
+      EXPECT( idle_wait( milliseconds( 40000 ), idle, s, 100 ) == milliseconds( 3000 ) );
+
+      s.rewards = 1;
+      EXPECT( idle_wait( milliseconds( 40000 ), idle, s, 100 ) == milliseconds( 3000 ) );
+
+      //a due time without anything queued is left over from the last settlement
+      s.payouts = 0;
+      s.rewards = 0;
+      EXPECT( idle_wait( milliseconds( 1000 ), idle, s, 100 ) == milliseconds( 2000 ) );
+   }
+
+   void check_parse_metrics() {
+      auto s = parse_metrics( metrics_due );
+      EXPECT_EQ( s.rewards, 12u );
+      EXPECT_EQ( s.payouts, 0u );
+      EXPECT_EQ( s.reward_due, 1u );
+      EXPECT( s.due( 1 ) );
+      EXPECT( !parse_metrics( metrics_empty ).due( 1 ) );
+
+      //two symbols are summed, and 64 bit counts come quoted
+      s = parse_metrics( "{\"rows\":[{\"queues\":[{\"sym\":\"DCN\",\"reward_count\":\"5000000000\",\"payout_count\":1},"
+                         "{\"sym\":\"OLD\",\"reward_count\":2,\"payout_count\":3}],\"reward_due\":7,\"payout_due\":9}]}" );
+      EXPECT_EQ( s.rewards, 5000000002u );
+      EXPECT_EQ( s.payouts, 4u );
+      EXPECT_EQ( s.reward_due, 7u );
+      EXPECT_EQ( s.payout_due, 9u );
+   }
+
+   task<> run( event_loop& loop, mock_node& node, keeper& k, unsigned& after_drain ) {
+      while( !node.drained ) {
+         co_await loop.sleep_for( milliseconds( 10 ) );
+      }
+      //the cranks already outstanding are rejected, one of them resets the work, and the idle
+      //polls that follow don't set it again
+      co_await loop.sleep_for( milliseconds( 300 ) );
+      after_drain = node.rejected;
+      EXPECT( !k.work.ready() );
+      co_await loop.sleep_for( milliseconds( 1000 ) );
+      EXPECT_EQ( node.rejected, after_drain );
+      loop.stop();
+   }
+
+}
+
+int main() {
+   check_idle_wait();
+   check_parse_metrics();
+
+   event_loop loop;
+   mock_node node( loop );
+   keeper k( loop );
+   k.node = resolve( node.url );
+   k.push = resolve( node.url + "/push" );
+   k.contract = "dconnect";
+   k.actor = "cranker";
+   k.permission = "active";
+   k.in_flight = 4;
+   k.poll = milliseconds( 50 );
+   k.idle = milliseconds( 400 );
+
+   unsigned after_drain = 0;
+   spawn( node.serve() );
+   k.start();
+   spawn( run( loop, node, k, after_drain ) );
+   loop.run();
+
+   //every submitter kept a crank outstanding while there was work, and never more than that
+   EXPECT_EQ( node.peak, k.in_flight );
+   EXPECT_EQ( k.submitted, node.accept_cranks );
+   EXPECT( after_drain >= 1 && after_drain <= 2 * k.in_flight );
+   EXPECT_EQ( k.drained, node.rejected );
+   EXPECT_EQ( k.failed, 0u );
+
+   //the polls once the queues are empty back off 100, 200 and 400ms, and stay at idle
+   const long expected[] = { 100, 200, 400, 400 };
+   EXPECT( node.empty_polls.size() >= 5 );
+   for( size_t i = 0; i < 4 && i + 1 < node.empty_polls.size(); i++ ) {
+      long ms = std::chrono::duration_cast<milliseconds>( node.empty_polls[i + 1] - node.empty_polls[i] ).count();
+      if( ms < expected[i] || ms > expected[i] + 40 ) {
+         fprintf( stderr, "idle poll %zu came after %ldms, expected %ldms\n", i + 1, ms, expected[i] );
+         failures()++;
+      }
+   }
+   return dconnect::test::finish( "keeper" );
+}
@@ -0,0 +1,139 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "test.hpp"
+
+#include "../leaderboard/board.hpp"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+
+using namespace dconnect;
+using namespace dconnect::test;
+
+//a leaderboard fed a random run of rewards against a sort of the full totals, worked out
+//here without a top k. Amounts come from a short list and rewards often share a time, so
+//totals and hot scores tie; a few hundred content ids and users against a top of 16 means
+//keys are evicted and have to come back as they catch up
+namespace {
+
+   const dconnect::symbol dcn{ ( dconnect::symbol::code_from_string( "DCN" ) << 8 ) | 4 };
+   const dconnect::symbol other{ ( dconnect::symbol::code_from_string( "OTHER" ) << 8 ) | 4 };
+
+   struct full_total {
+      uint64_t amount = 0;
+      uint64_t hot = 0;
+      uint64_t count = 0;
+   };
+
+   //the best n of every key, ties to the lower key as top_k breaks them
+   std::vector<top_k::item> sorted( const std::map<uint64_t, full_total>& totals, bool hot, size_t n ) {
+      std::vector<top_k::item> all;
+      for( const auto& t : totals ) {
+         all.push_back( top_k::item{ hot ? t.second.hot : t.second.amount, t.first } );
+      }
+      std::sort( all.begin(), all.end(), []( const top_k::item& a, const top_k::item& b ) {
+         return a.score > b.score || ( a.score == b.score && a.key < b.key );
+      });
+      all.resize( std::min( n, all.size() ) );
+      return all;
+   }
+
+   bool same( const std::vector<top_k::item>& a, const std::vector<top_k::item>& b ) {
+      if( a.size() != b.size() ) {
+         return false;
+      }
+      for( size_t i = 0; i < a.size(); i++ ) {
+         if( a[i].score != b[i].score || a[i].key != b[i].key ) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   void check( const leaderboard& lb, const std::map<uint64_t, full_total>& contents,
+               const std::map<uint64_t, full_total>& users, size_t k, size_t& ties, std::set<uint64_t>& ranked ) {
+      for( size_t n : { size_t( 1 ), size_t( 5 ), k, k + 10 } ) {
+         //the board holds k, so asking for more returns the k
+         size_t expected = std::min( n, k );
+         EXPECT( same( lb.top( leaderboard::content, n ), sorted( contents, false, expected ) ) );
+         EXPECT( same( lb.top( leaderboard::trending, n ), sorted( contents, true, expected ) ) );
+         EXPECT( same( lb.top( leaderboard::users, n ), sorted( users, false, expected ) ) );
+      }
+      auto best = sorted( users, false, k );
+      for( size_t i = 1; i < best.size(); i++ ) {
+         ties += best[i].score == best[i - 1].score;
+      }
+      for( const auto& i : sorted( contents, true, k ) ) {
+         ranked.insert( i.key );
+      }
+   }
+
+   //a key that ties the worst of a full board with a lower key takes its place
+   void check_tie_eviction() {
+      leaderboard lb( 2, dcn.code() );
+      event e{};
+      e.type = event::reward;
+      e.time = 1600000000;
+      e.quantity = dconnect::asset{ 100, dcn };
+      for( uint64_t content : { 5, 7, 3 } ) {
+         e.to = dconnect::name( 1000 + content );
+         e.content = content;
+         lb.add( e );
+      }
+      EXPECT( same( lb.top( leaderboard::content, 2 ), { { 100, 3 }, { 100, 5 } } ) );
+      EXPECT( same( lb.top( leaderboard::users, 2 ), { { 100, 1003 }, { 100, 1005 } } ) );
+   }
+
+}
+
+int main() {
+   const size_t k = 16;
+   const int64_t amounts[] = { 100, 200, 500, 1000 };
+   std::mt19937_64 rng( 11 );
+   leaderboard lb( k, dcn.code() );
+   std::map<uint64_t, full_total> contents, users;
+   auto fold = [&]( full_total& t, int64_t amount, uint64_t hot ) {
+      t.amount += amount;
+      t.hot = t.count++ == 0 ? hot : eosio::hot_add( t.hot, hot );
+   };
+
+   uint32_t time = 1600000000;
+   size_t ties = 0;
+   std::set<uint64_t> ranked;
+   for( int i = 0; i < 20000; i++ ) {
+      time += rng() % 4 == 0 ? 600 : 0;
+      event e{};
+      e.type = rng() % 8 == 0 ? event::settle : event::reward;
+      e.time = time;
+      e.to = dconnect::name( 1000 + rng() % 300 );
+      e.quantity = dconnect::asset{ amounts[rng() % 4], rng() % 10 == 0 ? other : dcn };
+      //a few content ids take most of the rewards, so the top keeps changing hands
+      e.content = rng() % 2 ? rng() % 20 : rng() % 500;
+      lb.add( e );
+      if( e.type != event::reward || e.quantity.symbol != dcn ) {
+         continue;
+      }
+      uint64_t hot = eosio::hot_score( e.quantity.amount, e.time );
+      fold( contents[e.content], e.quantity.amount, hot );
+      fold( users[e.to.value], e.quantity.amount, hot );
+      if( i % 1000 == 999 ) {
+         check( lb, contents, users, k, ties, ranked );
+      }
+   }
+   check( lb, contents, users, k, ties, ranked );
+   EXPECT_EQ( lb.content_count(), contents.size() );
+   EXPECT_EQ( lb.user_count(), users.size() );
+
+   //the run only means something if it ranked ties and evicted keys
+   EXPECT( ties > 0 );
+   EXPECT( ranked.size() > k );
+   EXPECT( contents.size() > 20 * k && users.size() > 10 * k );
+
+   check_tie_eviction();
+   return finish( "leaderboard" );
+}
@@ -0,0 +1,78 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "fixture.hpp"
+
+using namespace dconnect::test;
+
+//a memo row and the queue rows sharing it
+struct memo_row {
+   uint64_t id = 0;
+   std::string text;
+   uint64_t refs = 0;
+};
+
+//the id a memo is kept under, the first 8 bytes of its sha256
+static uint64_t memo_id( const std::string& memo ) {
+   capi_checksum256 hash;
+   sha256( memo.data(), memo.size(), &hash );
+   uint64_t id;
+   memcpy( &id, hash.hash, sizeof(id) );
+   return id;
+}
+
+static uint64_t memo_refs( const std::string& memo ) {
+   memo_row m;
+   if( !read_row( name( "memos" ), contract.value, memo_id( memo ), m ) ) {
+      return 0;
+   }
+   EXPECT_EQ( m.text, memo );
+   return m.refs;
+}
+
+int main() {
+   tester t( contract );
+   const name alice( "alice" ), bob( "bob" );
+   create_token( t, 10000000 );
+   t.push( name( "transfer" ), { issuer }, issuer, alice, dcn_amount( 1000000 ), std::string() );
+
+   t.push( name( "reward" ), { alice }, alice, bob, dcn_amount( 1000 ), std::string( "first" ), int64_t( 1 ) );
+   t.push( name( "reward" ), { alice }, alice, bob, dcn_amount( 1000 ), std::string( "first" ), int64_t( 1 ) );
+   t.push( name( "reward" ), { alice }, alice, bob, dcn_amount( 1000 ), std::string( "second" ), int64_t( 2 ) );
+   t.push( name( "reward" ), { alice }, alice, bob, dcn_amount( 1000 ), std::string(), int64_t( 2 ) );
+   EXPECT_EQ( memo_refs( "first" ), 2u );
+   EXPECT_EQ( memo_refs( "second" ), 1u );
+
+   //settling the first two rewards releases "first", and "second" is still found by its hash
+   t.advance( eosio::policy::lock_period() );
+   t.push( name( "crank" ), {}, uint32_t( 2 ) );
+   EXPECT_EQ( memo_refs( "first" ), 0u );
+   t.push( name( "reward" ), { alice }, alice, bob, dcn_amount( 1000 ), std::string( "second" ), int64_t( 2 ) );
+   EXPECT_EQ( memo_refs( "second" ), 2u );
+   EXPECT_EQ( eosio::sim::chain().db.find( { contract.value, contract.value, name( "memos" ).value } )->size(), 1u );
+
+   t.push( name( "crank" ), {}, uint32_t( 10 ) );
+   t.advance( eosio::policy::lock_period() );
+   t.push( name( "crank" ), {}, uint32_t( 10 ) );
+   EXPECT( eosio::sim::chain().db.find( { contract.value, contract.value, name( "memos" ).value } ) == nullptr );
+
+   //a retire merged into a queued payout keeps the first retire's memo, and stores nothing of its own
+   t.notify( bounty, name( "transfer" ), name( "funder" ), contract, bnt_amount( 10000000 ), std::string( "DCN" ) );
+   t.push( name( "retire" ), { alice }, alice, dcn_amount( 1000 ), std::string( "cashing out" ) );
+   t.push( name( "retire" ), { alice }, alice, dcn_amount( 1000 ), std::string( "cashing out again" ) );
+   EXPECT_EQ( memo_refs( "cashing out" ), 1u );
+   EXPECT_EQ( memo_refs( "cashing out again" ), 0u );
+   const auto* payouts = eosio::sim::chain().db.find( { contract.value, name( "payouts" ).value, name( "payouts" ).value } );
+   EXPECT( payouts != nullptr && payouts->size() == 1 );
+   if( payouts != nullptr && payouts->size() == 1 ) {
+      auto row = eosio::unpack<eosio::token::payout>( payouts->begin()->second );
+      EXPECT_EQ( row.memo, memo_id( "cashing out" ) );
+      EXPECT_EQ( row.quantity.amount, 2000 );
+   }
+   t.push( name( "crank" ), {}, uint32_t( 10 ) );
+   EXPECT( eosio::sim::chain().db.find( { contract.value, contract.value, name( "memos" ).value } ) == nullptr );
+
+   return finish( "memos" );
+}
@@ -0,0 +1,217 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "scenario.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+
+using namespace dconnect::test;
+
+//a migration as the README runs it: the contract's traces through dconnect-indexer, a snapshot
+//export, and the importrows actions that dconnect-snapshot prints, pushed at a contract on a
+//new account. The imported tables have to match the ones the traces came from
+namespace {
+
+   const name target( "dconnectnew" );
+
+   struct queue_metrics_row {
+      eosio::symbol_code sym;
+      uint64_t reward_count = 0;
+      asset pending_rewards;
+      asset settled_rewards;
+      uint64_t payout_count = 0;
+      asset pending_payouts;
+      asset settled_payouts;
+   };
+
+   struct metrics_row {
+      std::vector<queue_metrics_row> queues;
+      uint32_t reward_due = 0;
+      uint32_t payout_due = 0;
+      uint32_t lastcrank = 0;
+   };
+
+   //the tables importrows writes or rebuilds; memos, cursor and config are not carried over
+   const name migrated[] = { name( "stat" ), name( "accounts" ), name( "totals" ), name( "contents" ), name( "payouts" ),
+                             name( "pending" ), name( "buckets" ), name( "commitment" ), name( "bounties" ) };
+
+   std::vector<char> from_hex( const std::string& hex ) {
+      std::vector<char> bytes( hex.size() / 2 );
+      for( size_t i = 0; i < bytes.size(); i++ ) {
+         bytes[i] = char( std::stoi( hex.substr( 2 * i, 2 ), nullptr, 16 ) );
+      }
+      return bytes;
+   }
+
+   //pushes each printed importrows action, returning how many there were
+   int import_actions( tester& t, const std::string& command ) {
+      FILE* p = popen( command.c_str(), "r" );
+      int pushed = 0;
+      char buffer[1 << 16];
+      std::string line;
+      while( fgets( buffer, sizeof(buffer), p ) ) {
+         line += buffer;
+         if( line.back() != '\n' ) {
+            continue;
+         }
+         //cleos push action ACCOUNT importrows '["TABLE", "HEX"]' -p ACCOUNT@active
+         EXPECT( line.find( " push action " + target.to_string() + " importrows " ) != std::string::npos );
+         size_t table = line.find( "'[\"" ) + 3;
+         size_t hex = line.find( "\", \"", table );
+         std::string table_name = line.substr( table, hex - table );
+         std::string data = line.substr( hex + 4, line.find( '"', hex + 4 ) - hex - 4 );
+         t.push( name( "importrows" ), { target }, name( table_name ), from_hex( data ) );
+         pushed++;
+         line.clear();
+      }
+      EXPECT_EQ( pclose( p ), 0 );
+      return pushed;
+   }
+
+   std::string output_of( const std::string& command ) {
+      FILE* p = popen( command.c_str(), "r" );
+      std::string out;
+      char buffer[1 << 16];
+      size_t n;
+      while( ( n = fread( buffer, 1, sizeof(buffer), p ) ) > 0 ) {
+         out.append( buffer, n );
+      }
+      EXPECT_EQ( pclose( p ), 0 );
+      return out;
+   }
+
+   //rows of a table of the old account under the scope they move to
+   uint64_t moved_scope( name table, uint64_t scope ) {
+      return table == name( "contents" ) || table == name( "bounties" ) ? target.value : scope;
+   }
+
+   void compare_tables( const eosio::sim::database& before, const eosio::sim::database& after ) {
+      for( name table : migrated ) {
+         size_t scopes = 0;
+         for( const auto& t : before.tables ) {
+            if( t.first.code != contract.value || t.first.table != table.value ) {
+               continue;
+            }
+            scopes++;
+            auto imported = after.find( { target.value, moved_scope( table, t.first.scope ), table.value } );
+            if( imported == nullptr ) {
+               fprintf( stderr, "%s scope %s was not imported\n", table.to_string().c_str(), name( t.first.scope ).to_string().c_str() );
+               failures()++;
+               continue;
+            }
+            EXPECT_EQ( imported->size(), t.second.size() );
+            for( const auto& row : t.second ) {
+               auto itr = imported->find( row.first );
+               if( itr == imported->end() ) {
+                  fprintf( stderr, "%s row %llu was not imported\n", table.to_string().c_str(), (unsigned long long)row.first );
+                  failures()++;
+                  continue;
+               }
+               auto expected = row.second;
+               if( table == name( "payouts" ) ) {
+                  //queue rows are imported without their memo
+                  memset( expected.data() + 32, 0, 8 );
+               }
+               if( itr->second != expected ) {
+                  fprintf( stderr, "%s row %llu in scope %s differs\n", table.to_string().c_str(), (unsigned long long)row.first,
+                           name( t.first.scope ).to_string().c_str() );
+                  failures()++;
+               }
+            }
+         }
+         size_t imported_scopes = 0;
+         for( const auto& t : after.tables ) {
+            imported_scopes += t.first.code == target.value && t.first.table == table.value;
+         }
+         EXPECT_EQ( imported_scopes, scopes );
+      }
+
+      //the queue depths carry over, the settlement history doesn't
+      metrics_row m, n;
+      EXPECT( before.find( { contract.value, contract.value, name( "metrics" ).value } ) != nullptr );
+      m = eosio::unpack<metrics_row>( before.find( { contract.value, contract.value, name( "metrics" ).value } )->begin()->second );
+      n = eosio::unpack<metrics_row>( after.find( { target.value, target.value, name( "metrics" ).value } )->begin()->second );
+      EXPECT_EQ( m.reward_due, n.reward_due );
+      EXPECT_EQ( m.payout_due, n.payout_due );
+      EXPECT_EQ( m.queues.size(), n.queues.size() );
+      for( size_t i = 0; i < m.queues.size() && i < n.queues.size(); i++ ) {
+         EXPECT( m.queues[i].sym == n.queues[i].sym );
+         EXPECT_EQ( m.queues[i].reward_count, n.queues[i].reward_count );
+         EXPECT( m.queues[i].pending_rewards == n.queues[i].pending_rewards );
+         EXPECT_EQ( m.queues[i].payout_count, n.queues[i].payout_count );
+         EXPECT( m.queues[i].pending_payouts == n.queues[i].pending_payouts );
+      }
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   if( argc != 3 ) {
+      fprintf( stderr, "usage: %s INDEXER SNAPSHOT\n", argv[0] );
+      return 2;
+   }
+   std::string indexer = argv[1], snapshot = argv[2];
+   std::string prefix = "test-migration-" + std::to_string( getpid() );
+   std::string traces = prefix + ".traces", store = prefix + ".db", snap = prefix + ".snap";
+   std::string new_traces = prefix + "-new.traces", new_store = prefix + "-new.db", new_snap = prefix + "-new.snap";
+   std::string later_traces = prefix + "-later.traces", fresh_store = prefix + "-fresh.db";
+   auto index = [&]( const std::string& store, const std::string& traces, name account ) {
+      return system( ( indexer + " --store " + store + " --traces " + traces + " --contract " + account.to_string() + " > /dev/null" ).c_str() );
+   };
+
+   eosio::sim::database before;
+   {
+      tester t( contract );
+      run_lifecycle( t, []( const std::string&, const action_costs& ) {} );
+      before = eosio::sim::chain().db;
+      write_traces( traces, t.applied );
+   }
+
+   EXPECT_EQ( index( store, traces, contract ), 0 );
+   EXPECT_EQ( system( ( snapshot + " export --store " + store + " --out " + snap + " --contract " + contract.to_string() + " > /dev/null" ).c_str() ), 0 );
+
+   tester t( target );
+   int pushed = import_actions( t, snapshot + " actions --snapshot " + snap + " --contract " + target.to_string() + " --chunk 100" );
+   EXPECT( pushed > 5 );
+   compare_tables( before, eosio::sim::chain().db );
+
+   //an indexer following the new account sees the same rows in its importrows traces
+   size_t imported = t.applied.size();
+   write_traces( new_traces, t.applied );
+   EXPECT_EQ( index( new_store, new_traces, target ), 0 );
+   EXPECT_EQ( system( ( snapshot + " export --store " + new_store + " --out " + new_snap + " --contract " + target.to_string() + " > /dev/null" ).c_str() ), 0 );
+   std::string rows_of = " --contract " + target.to_string() + " --chunk 100";
+   EXPECT( output_of( snapshot + " actions --snapshot " + new_snap + rows_of ) == output_of( snapshot + " actions --snapshot " + snap + rows_of ) );
+
+   //a contents row left in the old account's scope is refused
+   std::vector<char> rows;
+   append_row( rows, contract.value, uint64_t( 100 ), name( "alice" ), uint32_t( 0 ), dcn_amount( 1 ), uint64_t( 100 ), uint64_t( 0 ) );
+   EXPECT_EQ( t.push_error( name( "importrows" ), { target }, name( "contents" ), rows ), "contents rows must be in the contract's own scope" );
+
+   //once the imported queues are settled the cursor is past their keys, and rows keyed below it
+   //would never be reached
+   t.advance( 2 * eosio::policy::lock_period() );
+   t.push( name( "crank" ), {}, uint32_t( 50 ) );
+   write_traces( new_traces, t.applied );
+   EXPECT_EQ( index( new_store, new_traces, target ), 0 );
+
+   //a store restored fresh follows a trace file that starts after the imports
+   write_traces( later_traces, t.applied, imported );
+   EXPECT( output_of( snapshot + " restore --snapshot " + snap + " --store " + fresh_store + " --fresh" ).find( "resumes at offset 0\n" ) != std::string::npos );
+   EXPECT_EQ( index( fresh_store, later_traces, target ), 0 );
+   uint32_t now = eosio::sim::chain().now;
+   for( name queue : { name( "rewards" ), name( "payouts" ) } ) {
+      rows.clear();
+      append_row( rows, queue.value, uint64_t( 0 ), bnt_amount( 0 ), name( "alice" ), uint64_t( 0 ), now, dcn_amount( 100 ), name( "bob" ), uint64_t( 100 ) );
+      EXPECT_EQ( t.push_error( name( "importrows" ), { target }, name( "payouts" ), rows ), "queue row key is below the settlement cursor" );
+   }
+
+   for( const auto& path : { traces, store, snap, new_traces, new_store, new_snap, later_traces, fresh_store } ) {
+      ::unlink( path.c_str() );
+   }
+   return finish( "migration" );
+}
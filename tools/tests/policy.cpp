@@ -0,0 +1,48 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "fixture.hpp"
+
+using namespace dconnect::test;
+
+//built with DCONNECT_RUNTIME_POLICY: a setconfig between actions has to change the lock
+//period, rates and memo limit the following actions use, after earlier actions read the defaults
+int main() {
+   static_assert( !eosio::policy::fixed, "test-policy needs the runtime policy build" );
+   tester t( contract );
+   const name alice( "alice" ), bob( "bob" );
+   create_token( t, 10000000 );
+   t.push( name( "transfer" ), { issuer }, issuer, alice, dcn_amount( 1000000 ), std::string() );
+   auto balance = [&]( name owner ) { return eosio::token::get_balance( contract, owner, dcn.code() ).amount; };
+   auto maturity = [&]() {
+      eosio::token::pending p;
+      EXPECT( read_row( name( "pending" ), alice.value, dcn.code().raw(), p ) );
+      return p.next_maturity;
+   };
+
+   //the defaults, read by the reward and the crank
+   t.push( name( "reward" ), { alice }, alice, bob, dcn_amount( 1000 ), std::string( "default policy" ), int64_t( 1 ) );
+   EXPECT_EQ( maturity(), eosio::sim::chain().now + 86400 );
+   EXPECT_EQ( t.push_error( name( "setconfig" ), { contract }, uint32_t( 100 ), int64_t( 1100 ), int64_t( 1050 ), int64_t( 1000 ),
+                            uint32_t( 16 ), int32_t( -1 ) ), "locked rewards must settle before the policy changes" );
+   t.advance( 86400 );
+   t.push( name( "crank" ), {}, uint32_t( 10 ) );
+   EXPECT_EQ( balance( alice ), 1000000 - 1000 + 1009 );
+   EXPECT_EQ( balance( bob ), 1 );
+
+   t.push( name( "setconfig" ), { contract }, uint32_t( 100 ), int64_t( 1100 ), int64_t( 1050 ), int64_t( 1000 ), uint32_t( 16 ), int32_t( -1 ) );
+   EXPECT_EQ( t.push_error( name( "reward" ), { alice }, alice, bob, dcn_amount( 1000 ), std::string( "seventeen chars!!" ), int64_t( 1 ) ),
+              "memo is too long" );
+   t.push( name( "reward" ), { alice }, alice, bob, dcn_amount( 1000 ), std::string( "sixteen chars!!!" ), int64_t( 1 ) );
+   EXPECT_EQ( maturity(), eosio::sim::chain().now + 100 );
+   t.advance( 99 );
+   EXPECT_EQ( t.push_error( name( "crank" ), {}, uint32_t( 10 ) ), "nothing to settle" );
+   t.advance( 1 );
+   t.push( name( "crank" ), {}, uint32_t( 10 ) );
+   EXPECT_EQ( balance( alice ), 1000000 - 1000 + 1009 - 1000 + 1100 );
+   EXPECT_EQ( balance( bob ), 1 + 50 );
+
+   return finish( "policy" );
+}
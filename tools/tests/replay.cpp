@@ -0,0 +1,87 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "scenario.hpp"
+
+#include "../indexer/store.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+
+using namespace dconnect::test;
+
+//the scenario's traces through dconnect-replay on several threads with --verify, which exits
+//non-zero when the parallel replay fails or disagrees with the serial one, and the store it
+//saves against the one dconnect-indexer builds from the same traces
+namespace {
+
+   std::string output_of( const std::string& command, int& status ) {
+      FILE* p = popen( command.c_str(), "r" );
+      std::string out;
+      char buffer[4096];
+      size_t n;
+      while( ( n = fread( buffer, 1, sizeof(buffer), p ) ) > 0 ) {
+         out.append( buffer, n );
+      }
+      status = pclose( p );
+      return out;
+   }
+
+   void compare_stores( dconnect::store& replayed, dconnect::store& indexed ) {
+      EXPECT_EQ( replayed.offset(), indexed.offset() );
+      EXPECT_EQ( replayed.records(), indexed.records() );
+      EXPECT_EQ( replayed.used(), indexed.used() );
+      EXPECT( memcmp( &replayed.meta(), &indexed.meta(), sizeof(dconnect::region_header) ) == 0 );
+      replayed.for_each( [&]( const dconnect::slot& s ) {
+         auto* p = indexed.find<decltype(s.payload)>( s.kind, s.k1, s.k2 );
+         if( !p || memcmp( p, s.payload, sizeof(s.payload) ) != 0 ) {
+            fprintf( stderr, "slot of kind %u at %llu, %llu differs\n", unsigned( s.kind ), (unsigned long long)s.k1,
+                     (unsigned long long)s.k2 );
+            failures()++;
+         }
+      });
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   if( argc != 3 ) {
+      fprintf( stderr, "usage: %s REPLAY INDEXER\n", argv[0] );
+      return 2;
+   }
+   std::string replay = argv[1], indexer = argv[2];
+   std::string prefix = "test-replay-" + std::to_string( getpid() );
+   std::string traces = prefix + ".traces", replayed = prefix + "-replayed.db", indexed = prefix + "-indexed.db";
+
+   {
+      tester t( contract );
+      run_scenario( t, []( const std::string&, const action_costs& ) {} );
+      write_traces( traces, t.applied );
+   }
+
+   std::string args = " --traces " + traces + " --contract " + contract.to_string();
+   for( const char* threads : { "2", "4", "8" } ) {
+      ::unlink( replayed.c_str() );
+      int status;
+      std::string out = output_of( replay + args + " --threads " + threads + " --verify --store " + replayed + " 2>&1", status );
+      EXPECT_EQ( status, 0 );
+      if( status != 0 || out.find( "matches serial replay\n" ) == std::string::npos ) {
+         fprintf( stderr, "replay on %s threads: %s", threads, out.c_str() );
+         failures()++;
+      }
+   }
+   EXPECT_EQ( system( ( indexer + " --store " + indexed + args + " > /dev/null" ).c_str() ), 0 );
+
+   if( ::access( replayed.c_str(), F_OK ) == 0 && ::access( indexed.c_str(), F_OK ) == 0 ) {
+      dconnect::store a( replayed, 0 ), b( indexed, 0 );
+      compare_stores( a, b );
+   }
+
+   for( const auto& path : { traces, replayed, indexed } ) {
+      ::unlink( path.c_str() );
+   }
+   return finish( "replay" );
+}
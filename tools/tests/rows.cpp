@@ -0,0 +1,134 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "scenario.hpp"
+
+#include <common/rows.hpp>
+
+using namespace dconnect::test;
+
+//the views in common/rows.hpp read fields at hand written offsets. After every step of the
+//scenario each row the contract has written is unpacked with the contract's own struct and
+//read through its view, and every field has to come out the same
+namespace {
+
+   typedef eosio::token token;
+
+   std::string where;
+
+   void same( const eosio::asset& a, const dconnect::asset& v, const char* field ) {
+      if( a.amount != v.amount || a.symbol.raw() != v.symbol.value ) {
+         fprintf( stderr, "%s: %s differs\n", where.c_str(), field );
+         failures()++;
+      }
+   }
+
+   void same( uint64_t a, uint64_t v, const char* field ) {
+      if( a != v ) {
+         fprintf( stderr, "%s: %s is %llu, the view reads %llu\n", where.c_str(), field, (unsigned long long)a, (unsigned long long)v );
+         failures()++;
+      }
+   }
+
+   void same( name a, dconnect::name v, const char* field ) { same( a.value, v.value, field ); }
+
+   template<typename Row, typename View>
+   std::pair<Row, View> both( const std::vector<char>& bytes ) {
+      EXPECT_EQ( bytes.size(), View::packed_size );
+      return { eosio::unpack<Row>( bytes ), View( bytes.data(), bytes.size() ) };
+   }
+
+   void check_row( name table, uint64_t pk, const std::vector<char>& bytes ) {
+      if( table == name( "accounts" ) ) {
+         auto [r, v] = both<token::account, dconnect::account_view>( bytes );
+         same( r.balance, v.balance(), "balance" );
+         same( pk, v.primary_key(), "primary key" );
+      } else if( table == name( "stat" ) ) {
+         auto [r, v] = both<token::currency_stats, dconnect::currency_stats_view>( bytes );
+         same( r.supply, v.supply(), "supply" );
+         same( r.max_supply, v.max_supply(), "max_supply" );
+         same( r.issuer, v.issuer(), "issuer" );
+         same( r.bounty_contract, v.bounty_contract(), "bounty_contract" );
+         same( r.bounty, v.bounty(), "bounty" );
+         same( r.lastpay, v.lastpay(), "lastpay" );
+         same( r.bounty_rate, v.bounty_rate(), "bounty_rate" );
+         same( pk, v.primary_key(), "primary key" );
+      } else if( table == name( "payouts" ) ) {
+         auto [r, v] = both<token::payout, dconnect::payout_view>( bytes );
+         same( r.pk, v.pk(), "pk" );
+         same( r.bounty, v.bounty(), "bounty" );
+         same( r.to, v.to(), "to" );
+         same( r.memo, v.memo(), "memo" );
+         same( r.time, v.time(), "time" );
+         same( r.quantity, v.quantity(), "quantity" );
+         same( r.vote, v.vote(), "vote" );
+         same( r.content, v.content(), "content" );
+         same( pk, v.primary_key(), "primary key" );
+      } else if( table == name( "totals" ) || table == name( "contents" ) ) {
+         auto [r, v] = both<token::total, dconnect::total_view>( bytes );
+         same( r.pk, v.pk(), "pk" );
+         same( r.name, v.name(), "name" );
+         same( r.time, v.time(), "time" );
+         same( r.quantity, v.quantity(), "quantity" );
+         same( r.content, v.content(), "content" );
+         same( r.hot, v.hot(), "hot" );
+         same( pk, v.primary_key(), "primary key" );
+      } else if( table == name( "pending" ) ) {
+         auto [r, v] = both<token::pending, dconnect::pending_view>( bytes );
+         same( r.locked, v.locked(), "locked" );
+         same( r.expected, v.expected(), "expected" );
+         same( r.count, v.count(), "count" );
+         same( r.next_maturity, v.next_maturity(), "next_maturity" );
+         same( pk, v.primary_key(), "primary key" );
+      } else if( table == name( "buckets" ) ) {
+         auto [r, v] = both<token::bucket, dconnect::bucket_view>( bytes );
+         same( r.start, v.start(), "start" );
+         same( r.count, v.count(), "count" );
+         same( r.total, v.total(), "total" );
+         same( pk, v.primary_key(), "primary key" );
+      } else if( table == name( "commitment" ) ) {
+         auto [r, v] = both<token::commitment_state, dconnect::commitment_view>( bytes );
+         same( r.held, v.held(), "held" );
+         same( r.holders, v.holders(), "holders" );
+         same( r.digest, v.digest(), "digest" );
+         same( r.counted_to, v.counted_to(), "counted_to" );
+         same( pk, v.primary_key(), "primary key" );
+      } else if( table == name( "memos" ) ) {
+         auto r = eosio::unpack<token::memo_entry>( bytes );
+         dconnect::memo_entry_view v( bytes.data(), bytes.size() );
+         same( r.id, v.id(), "id" );
+         EXPECT( r.text == v.text() );
+         same( r.refs, v.refs(), "refs" );
+         same( pk, v.primary_key(), "primary key" );
+      }
+   }
+
+}
+
+int main() {
+   std::set<uint64_t> seen;
+   tester t( contract );
+   run_scenario( t, [&]( const std::string& step, const action_costs& ) {
+      for( const auto& table : eosio::sim::chain().db.tables ) {
+         if( table.first.code != contract.value ) {
+            continue;
+         }
+         for( const auto& row : table.second ) {
+            where = "after " + step + ", " + name( table.first.table ).to_string() + " row " + std::to_string( row.first );
+            check_row( name( table.first.table ), row.first, row.second );
+            seen.insert( table.first.table );
+         }
+      }
+   });
+
+   //every table with a view has to have had rows for the views to be checked at all
+   for( const char* table : { "accounts", "stat", "payouts", "totals", "contents", "pending", "buckets", "commitment", "memos" } ) {
+      if( seen.count( name( table ).value ) == 0 ) {
+         fprintf( stderr, "the scenario left no %s rows\n", table );
+         failures()++;
+      }
+   }
+   return finish( "rows" );
+}
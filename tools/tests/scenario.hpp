@@ -0,0 +1,117 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include "fixture.hpp"
+
+#include <common/trace.hpp>
+
+#include <functional>
+
+//one pass through every action the contract takes, from create to an import from an older
+//deployment, for the tests that check what the actions send and leave in the tables
+namespace dconnect { namespace test {
+
+   using eosio::sim::action_costs;
+
+   //called after each step with its label and the costs of the action it pushed
+   typedef std::function<void( const std::string&, const action_costs& )> scenario_step;
+
+   const symbol old( "OLD", 4 );
+
+   inline asset old_amount( int64_t amount ) { return asset( amount, old ); }
+
+   //a row for importrows, packed after its scope
+   template<typename... Fields>
+   void append_row( std::vector<char>& rows, uint64_t scope, const Fields&... fields ) {
+      auto packed = eosio::pack( std::make_tuple( scope, fields... ) );
+      rows.insert( rows.end(), packed.begin(), packed.end() );
+   }
+
+   //a DCN token from create through settlement, leaving one reward locked and one payout pending
+   inline void run_lifecycle( tester& t, const scenario_step& step ) {
+      const name alice( "alice" ), bob( "bob" ), carol( "carol" ), funder( "funder" );
+      auto push = [&]( const std::string& label, auto... args ) {
+         step( label, t.push( args... ) );
+      };
+
+      push( "create", name( "create" ), std::vector<name>{ contract }, issuer, dcn_amount( 1000000000000000 ), bounty, bnt_amount( 0 ), uint64_t( 0 ) );
+      push( "issue", name( "issue" ), std::vector<name>{ issuer }, issuer, dcn_amount( 100000000 ), std::string( "issued" ) );
+      push( "issue to another account", name( "issue" ), std::vector<name>{ issuer }, alice, dcn_amount( 10000000 ), std::string( "issued" ) );
+      push( "transfer to a new account", name( "transfer" ), std::vector<name>{ issuer }, issuer, bob, dcn_amount( 10000000 ), std::string() );
+      push( "transfer to an existing account", name( "transfer" ), std::vector<name>{ issuer }, issuer, alice, dcn_amount( 1000000 ), std::string() );
+      push( "open", name( "open" ), std::vector<name>{ carol }, carol, dcn, carol );
+      push( "close", name( "close" ), std::vector<name>{ carol }, carol, dcn );
+      step( "bounty top up", t.notify( bounty, name( "transfer" ), funder, contract, bnt_amount( 10000000 ), std::string( "DCN" ) ) );
+
+      push( "reward", name( "reward" ), std::vector<name>{ alice }, alice, bob, dcn_amount( 100000 ), std::string( "first post" ), int64_t( 1 ) );
+      push( "reward, existing totals", name( "reward" ), std::vector<name>{ alice }, alice, bob, dcn_amount( 50000 ), std::string( "first post" ), int64_t( 1 ) );
+      push( "reward, new content", name( "reward" ), std::vector<name>{ bob }, bob, alice, dcn_amount( 100000 ), std::string( "second post" ), int64_t( 2 ) );
+      push( "retire", name( "retire" ), std::vector<name>{ bob }, bob, dcn_amount( 10000 ), std::string( "cashing out" ) );
+      push( "retire, merged", name( "retire" ), std::vector<name>{ bob }, bob, dcn_amount( 10000 ), std::string( "cashing out" ) );
+      push( "crank payouts", name( "crank" ), std::vector<name>{}, uint32_t( 10 ) );
+      t.advance( eosio::policy::lock_period() );
+      push( "crank rewards", name( "crank" ), std::vector<name>{}, uint32_t( 10 ) );
+      push( "pay", name( "pay" ), std::vector<name>{ contract } );
+      push( "reward, left locked", name( "reward" ), std::vector<name>{ alice }, alice, bob, dcn_amount( 20000 ), std::string(), int64_t( 1 ) );
+      push( "retire, left pending", name( "retire" ), std::vector<name>{ bob }, bob, dcn_amount( 10000 ), std::string() );
+   }
+
+   //tables of an older deployment imported next to the DCN token, then settled with it
+   inline void run_import( tester& t, const scenario_step& step ) {
+      const name alice( "alice" ), bob( "bob" );
+      auto push = [&]( const std::string& label, auto... args ) {
+         step( label, t.push( args... ) );
+      };
+
+      //an older deployment's OLD token: 300 issued, 250 held, 50 locked in two rewards
+      //and one retire still waiting on its bounty
+      uint32_t now = eosio::sim::chain().now;
+      std::vector<char> rows;
+      append_row( rows, old.code().raw(), old_amount( 3000000 ), old_amount( 10000000000 ), issuer, bounty, bnt_amount( 0 ), now, uint64_t( 0 ) );
+      push( "import stat", name( "importrows" ), std::vector<name>{ contract }, name( "stat" ), rows );
+
+      rows.clear();
+      append_row( rows, alice.value, old_amount( 1000000 ) );
+      append_row( rows, bob.value, old_amount( 1500000 ) );
+      push( "import accounts", name( "importrows" ), std::vector<name>{ contract }, name( "accounts" ), rows );
+
+      rows.clear();
+      append_row( rows, alice.value, old.code().raw(), alice, now, old_amount( 500000 ), uint64_t( 100 ), uint64_t( 0 ) );
+      push( "import totals", name( "importrows" ), std::vector<name>{ contract }, name( "totals" ), rows );
+
+      rows.clear();
+      append_row( rows, contract.value, uint64_t( 100 ), alice, now, old_amount( 500000 ), uint64_t( 100 ), uint64_t( 0 ) );
+      push( "import contents", name( "importrows" ), std::vector<name>{ contract }, name( "contents" ), rows );
+
+      rows.clear();
+      append_row( rows, name( "payouts" ).value, uint64_t( 1000 ), bnt_amount( 100 ), alice, uint64_t( 7 ), now, old_amount( 10000 ), name(), uint64_t( 0 ) );
+      uint32_t locked = now - eosio::policy::lock_period();
+      append_row( rows, name( "rewards" ).value, uint64_t( 1000 ), bnt_amount( 0 ), alice, uint64_t( 7 ), locked, old_amount( 300000 ), bob, uint64_t( 100 ) );
+      append_row( rows, name( "rewards" ).value, uint64_t( 1001 ), bnt_amount( 0 ), alice, uint64_t( 7 ), locked, old_amount( 200000 ), bob, uint64_t( 100 ) );
+      push( "import payouts", name( "importrows" ), std::vector<name>{ contract }, name( "payouts" ), rows );
+
+      t.advance( eosio::policy::lock_period() );
+      push( "crank imported", name( "crank" ), std::vector<name>{}, uint32_t( 10 ) );
+   }
+
+   //the actions a tester applied, as the trace file the off-chain tools read
+   inline void write_traces( const std::string& path, const std::vector<eosio::sim::applied_action>& applied, size_t from = 0 ) {
+      FILE* f = fopen( path.c_str(), "wb" );
+      for( size_t i = from; i < applied.size(); i++ ) {
+         const auto& a = applied[i];
+         dconnect::trace_header h{ uint32_t( a.data.size() ), a.time, a.code.value, a.action.value };
+         fwrite( &h, sizeof(h), 1, f );
+         fwrite( a.data.data(), 1, a.data.size(), f );
+      }
+      fclose( f );
+   }
+
+   inline void run_scenario( tester& t, const scenario_step& step ) {
+      run_lifecycle( t, step );
+      run_import( t, step );
+   }
+
+} }
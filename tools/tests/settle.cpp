@@ -0,0 +1,70 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "test.hpp"
+
+#include <dconnect-reward/settle.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace dconnect::test;
+
+//the rates policy.hpp defaults to, which the int64 arithmetic before settle_batch hard coded
+const int64_t payout_rate = 1009, vote_rate = 1001, rate_base = 1000;
+const int64_t max_amount = ( 1ll << 62 ) - 1;
+
+//q * rate / base without ever forming q * rate, exact for any amount an asset can hold
+static int64_t split( int64_t q, int64_t rate, int64_t base ) {
+   return q / base * rate + q % base * rate / base;
+}
+
+static void check( int64_t q ) {
+   int64_t payout, cut, minted;
+   eosio::settle_batch( &q, &payout, &cut, &minted, 1, payout_rate, vote_rate, rate_base );
+   EXPECT_EQ( payout, split( q, payout_rate, rate_base ) );
+   EXPECT_EQ( cut, split( q, vote_rate, rate_base ) - q );
+   EXPECT_EQ( minted, payout + cut - q );
+   EXPECT( payout >= q && cut >= 0 && minted >= 0 );
+
+   //up to where q * rate fits in 64 bits, the results are the ones the int64 path gave
+   if( q <= std::numeric_limits<int64_t>::max() / payout_rate ) {
+      EXPECT_EQ( payout, q * payout_rate / rate_base );
+   }
+   if( q <= std::numeric_limits<int64_t>::max() / vote_rate ) {
+      EXPECT_EQ( cut, q * vote_rate / rate_base - q );
+   }
+}
+
+int main() {
+   const int64_t payout_limit = std::numeric_limits<int64_t>::max() / payout_rate;
+   const int64_t vote_limit = std::numeric_limits<int64_t>::max() / vote_rate;
+   std::vector<int64_t> amounts = { 1, 2, 999, 1000, 1001, 1999, 2000, 1000000,
+                                    payout_limit - 1, payout_limit, payout_limit + 1,
+                                    vote_limit - 1, vote_limit, vote_limit + 1,
+                                    max_amount - 1000, max_amount - 1, max_amount };
+   std::mt19937_64 rng( 42 );
+   for( int shift = 0; shift < 62; shift++ ) {
+      for( int i = 0; i < 64; i++ ) {
+         amounts.push_back( 1 + int64_t( rng() >> ( 64 - shift - 1 ) ) % max_amount );
+      }
+   }
+   for( auto q : amounts ) {
+      check( q );
+   }
+
+   //a batch gives each amount what it gets alone
+   std::vector<int64_t> payout( amounts.size() ), cut( amounts.size() ), minted( amounts.size() );
+   eosio::settle_batch( amounts.data(), payout.data(), cut.data(), minted.data(), amounts.size(), payout_rate, vote_rate, rate_base );
+   for( size_t i = 0; i < amounts.size(); i++ ) {
+      int64_t p, c, m;
+      eosio::settle_batch( &amounts[i], &p, &c, &m, 1, payout_rate, vote_rate, rate_base );
+      EXPECT( payout[i] == p && cut[i] == c && minted[i] == m );
+   }
+
+   return finish( "settle" );
+}
@@ -0,0 +1,83 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "test.hpp"
+
+#include "../indexer/store.hpp"
+
+#include <unistd.h>
+
+#include <map>
+#include <random>
+#include <tuple>
+
+using namespace dconnect;
+
+typedef std::map<std::tuple<uint64_t, uint64_t>, uint64_t> model;
+
+//every slot of the store against the model, both ways
+static bool same( store& db, const model& m ) {
+   bool ok = db.used() == m.size();
+   for( const auto& e : m ) {
+      auto* v = db.find<uint64_t>( kind::balance, std::get<0>( e.first ), std::get<1>( e.first ) );
+      ok = ok && v && *v == e.second;
+   }
+   return ok;
+}
+
+int main() {
+   std::string path = "test-store-" + std::to_string( getpid() ) + ".db";
+   ::unlink( path.c_str() );
+   std::mt19937_64 rng( 7 );
+   model committed, working;
+   {
+      store db( path, 4096 );
+      //commits only copy the pages written since the last one, so every round writes a
+      //different handful of slots and checks that nothing older is lost on the way
+      for( int round = 0; round < 200; round++ ) {
+         for( int i = 0; i < 40; i++ ) {
+            uint64_t owner = rng() % 2000, code = rng() % 3;
+            if( rng() % 4 == 0 ) {
+               db.erase( kind::balance, owner, code );
+               working.erase( { owner, code } );
+            } else {
+               uint64_t amount = rng();
+               db.upsert<uint64_t>( kind::balance, owner, code ) = amount;
+               working[{ owner, code }] = amount;
+            }
+         }
+         db.meta().reward_tail = round;
+         db.commit( round, round );
+         committed = working;
+         EXPECT( same( db, working ) );
+      }
+
+      //changes after the last commit are not part of it
+      db.upsert<uint64_t>( kind::balance, 5000, 0 ) = 1;
+      auto first = committed.begin()->first;
+      db.erase( kind::balance, std::get<0>( first ), std::get<1>( first ) );
+   }
+   {
+      store db( path, 0 );
+      EXPECT_EQ( db.offset(), 199u );
+      EXPECT_EQ( db.meta().reward_tail, 199u );
+      EXPECT( same( db, committed ) );
+      EXPECT( db.find<uint64_t>( kind::balance, 5000, 0 ) == nullptr );
+
+      //and a reopened store carries on committing from where it was
+      db.upsert<uint64_t>( kind::balance, 6000, 0 ) = 2;
+      committed[{ 6000, 0 }] = 2;
+      db.commit( 200, 200 );
+      db.upsert<uint64_t>( kind::balance, 6001, 0 ) = 3;
+      committed[{ 6001, 0 }] = 3;
+      db.commit( 201, 201 );
+   }
+   {
+      store db( path, 0 );
+      EXPECT( same( db, committed ) );
+   }
+   ::unlink( path.c_str() );
+   return dconnect::test::finish( "store" );
+}
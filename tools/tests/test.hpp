@@ -0,0 +1,38 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+//the checks the tool tests make. A failed check is reported and counted, and the test exits
+//with the count so ctest sees it
+namespace dconnect { namespace test {
+
+   inline int& failures() {
+      static int n = 0;
+      return n;
+   }
+
+   inline void expect( bool ok, const char* what, const char* file, int line ) {
+      if( !ok ) {
+         fprintf( stderr, "%s:%d: check failed: %s\n", file, line, what );
+         failures()++;
+      }
+   }
+
+   inline int finish( const char* test ) {
+      if( failures() == 0 ) {
+         printf( "%s: ok\n", test );
+      } else {
+         fprintf( stderr, "%s: %d checks failed\n", test, failures() );
+      }
+      return failures() == 0 ? 0 : 1;
+   }
+
+} }
+
+#define EXPECT( cond ) dconnect::test::expect( ( cond ), #cond, __FILE__, __LINE__ )
+#define EXPECT_EQ( a, b ) dconnect::test::expect( ( a ) == ( b ), #a " == " #b, __FILE__, __LINE__ )